@@ -11,11 +11,11 @@
 #include "ga_material.h"
 #include "ss_boilerplate.hpp"
 
-ga_cube_component::ga_cube_component(std::string& source_vs, std::string& source_fs,
+ga_cube_component::ga_cube_component(const ga_shader_source& source_vs, const ga_shader_source& source_fs,
 	std::unique_ptr<ga_material>&& material) : _material(std::move(material))
 {
 	_transform.make_identity();
-	_material->init(source_vs, source_fs);
+	_material->begin_init(source_vs, source_fs);
 
 	static GLfloat color[] =
 	{
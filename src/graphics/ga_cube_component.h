@@ -17,11 +17,12 @@
 
 /*
 ** Renderable basic textured cubed.
+** The material's program is only started here; poll it before drawing.
 */
 class ga_cube_component
 {
 public:
-	ga_cube_component(std::string& source_vs, std::string& source_fs, std::unique_ptr<ga_material>&& bp);
+	ga_cube_component(const ga_shader_source& source_vs, const ga_shader_source& source_fs, std::unique_ptr<ga_material>&& bp);
 	virtual ~ga_cube_component();
 
 	std::unique_ptr<ga_material> _material;
@@ -8,6 +8,8 @@
 */
 
 #include "ga_material.h"
+#include "ga_shader_cache.h"
+#include "ga_program_binary_cache.h"
 #include "ss_graph.hpp"
 
 #include <iostream>
@@ -25,31 +27,110 @@ ga_material::ga_material()
 
 ga_material::~ga_material()
 {
-	if (_vs) { delete _vs; }
-	if (_fs) { delete _fs; }
 	if (_program) { delete _program; }
 }
 
 bool ga_material::init(std::string& source_vs, std::string& source_fs)
 {
-	_vs = new ga_shader(source_vs.c_str(), GL_VERTEX_SHADER);
-	if (not _vs->compile()) {
-        assert("Failed to compile vertex shader");
+	ga_shader_source vs;
+	vs.append(source_vs);
+	ga_shader_source fs;
+	fs.append(source_fs);
+	return init(vs, fs);
+}
+
+bool ga_material::init(const ga_shader_source& source_vs, const ga_shader_source& source_fs)
+{
+	if (not load_binary(source_vs, source_fs)) {
+		submit(source_vs, source_fs);
+		finish();
 	}
+	return _linked;
+}
 
-	_fs = new ga_shader(source_fs.c_str(), GL_FRAGMENT_SHADER);
-	if (not _fs->compile()) {
-        assert("Failed to compile fragment shader");
+void ga_material::begin_init(const ga_shader_source& source_vs, const ga_shader_source& source_fs)
+{
+	if (load_binary(source_vs, source_fs)) {
+		return;
+	}
+	if (ga_program::compiles_in_parallel()) {
+		submit(source_vs, source_fs);
 	}
+	else {
+		/* The pieces belong to the caller, so keep a copy for the compile in poll. */
+		_deferred_vs.clear();
+		_deferred_fs.clear();
+		for (size_t i = 0; i < source_vs._pieces.size(); ++i) {
+			_deferred_vs.append(source_vs._pieces[i], size_t(source_vs._lengths[i]));
+		}
+		for (size_t i = 0; i < source_fs._pieces.size(); ++i) {
+			_deferred_fs.append(source_fs._pieces[i], size_t(source_fs._lengths[i]));
+		}
+	}
+	_pending = true;
+}
+
+bool ga_material::poll(bool& linked)
+{
+	if (_pending) {
+		if (not _program->is_link_complete()) {
+			return false;
+		}
+		finish();
+	}
+	linked = _linked;
+	return true;
+}
 
+bool ga_material::load_binary(const ga_shader_source& source_vs, const ga_shader_source& source_fs)
+{
 	_program = new ga_program();
+
+	/* A stored binary skips both compiles and the link. */
+	GLenum stage = GL_FRAGMENT_SHADER;
+	_key = source_fs.hash(SS_Hash::Bytes(source_vs.hash(), &stage, sizeof(stage)));
+	_linked = ga_program_binary_cache::load(*_program, _key);
+	return _linked;
+}
+
+void ga_material::submit(const ga_shader_source& source_vs, const ga_shader_source& source_fs)
+{
+	_vs = ga_shader_cache::get(source_vs, GL_VERTEX_SHADER);
+	_fs = ga_shader_cache::get(source_fs, GL_FRAGMENT_SHADER);
+
 	_program->attach(*_vs);
 	_program->attach(*_fs);
-	if (not _program->link()) {
-        assert("Failed to link shader program");
+	ga_program_binary_cache::prepare(*_program);
+	_program->begin_link();
+}
+
+void ga_material::finish()
+{
+	if (not _deferred_vs.empty()) {
+		ga_shader_source vs;
+		vs.append(_deferred_vs);
+		ga_shader_source fs;
+		fs.append(_deferred_fs);
+		submit(vs, fs);
+		_deferred_vs.clear();
+		_deferred_fs.clear();
 	}
+	_pending = false;
 
-	return true;
+	_linked = _program->is_linked();
+	if (_linked) {
+		ga_program_binary_cache::store(*_program, _key);
+		return;
+	}
+	if (not _vs->is_compiled()) {
+		ga_shader_cache::discard(*_vs);
+        assert("Failed to compile vertex shader");
+	}
+	if (not _fs->is_compiled()) {
+		ga_shader_cache::discard(*_fs);
+        assert("Failed to compile fragment shader");
+	}
+	assert("Failed to link shader program");
 }
 
 unsigned int ga_material::set_uniforms_by_type(Parameter_Data* p_data, unsigned int texture_id) {
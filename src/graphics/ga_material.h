@@ -33,13 +33,33 @@ public:
 	virtual ~ga_material();
 
 	virtual bool init(std::string& source_vs, std::string& source_fs);
+	virtual bool init(const ga_shader_source& source_vs, const ga_shader_source& source_fs);
+	/*
+	** Start building the program without waiting for it. The driver compiles in the background
+	** when it can; otherwise the sources are kept and compiled by the first poll.
+	*/
+	void begin_init(const ga_shader_source& source_vs, const ga_shader_source& source_fs);
+	/* True once the program is built, setting whether it linked. */
+	bool poll(bool& linked);
 	virtual unsigned int set_uniforms_by_type(struct Parameter_Data* p_data, unsigned int texture_id);
 
 	virtual void bind(const ga_mat4f& view, const ga_mat4f& proj, const ga_mat4f& transform, const std::vector<std::unique_ptr<Parameter_Data>>& p_data);
 
-    ga_shader* _vs;
-	ga_shader* _fs;
-	ga_program* _program;
+	/* Shared with every other material compiled from the same source. @see ga_shader_cache */
+	std::shared_ptr<ga_shader> _vs;
+	std::shared_ptr<ga_shader> _fs;
+	ga_program* _program = nullptr;
+
+private:
+	bool load_binary(const ga_shader_source& source_vs, const ga_shader_source& source_fs);
+	void submit(const ga_shader_source& source_vs, const ga_shader_source& source_fs);
+	void finish();
+
+	uint64_t _key = 0;
+	bool _pending = false;
+	bool _linked = false;
+	std::string _deferred_vs;
+	std::string _deferred_fs;
 	
 
 };
@@ -18,11 +18,23 @@
 #include "../math/ga_mat2f.h"
 #include <iostream>
 #include <cassert>
+#include <cstring>
+
+/* The loader is generated for GL 3.3, which predates parallel_shader_compile. */
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+bool ga_program::_parallel = false;
 
 void ga_uniform::set(float scalar)
 {
 	glUniform1f(_location, scalar);
 }
+void ga_uniform::set(const int32_t value)
+{
+	glUniform1i(_location, value);
+}
 void ga_uniform::set(const ga_vec2f& vec)
 {
 	glUniform2fv(_location, 1, vec.axes);
@@ -69,21 +81,63 @@ void ga_uniform::set(const unsigned int* tex_id, uint32_t unit) {
 
 ga_uniform::ga_uniform(int32_t location) : _location(location) {}
 
+void ga_shader_source::append(const char* text, uint32_t length)
+{
+	_pieces.push_back(text);
+	_lengths.push_back(int32_t(length));
+}
+
+void ga_shader_source::append(const std::string& text)
+{
+	append(text.data(), uint32_t(text.size()));
+}
+
+void ga_shader_source::clear()
+{
+	_pieces.clear();
+	_lengths.clear();
+}
+
+uint64_t ga_shader_source::hash(uint64_t seed) const
+{
+	for (size_t i = 0; i < _pieces.size(); ++i)
+	{
+		seed = SS_Hash::Bytes(seed, _pieces[i], size_t(_lengths[i]));
+	}
+	return seed;
+}
+
 ga_shader::ga_shader(const char* source, GLenum type)
 {
 	_handle = glCreateShader(type);
 	glShaderSource(_handle, 1, &source, 0);
 }
 
+ga_shader::ga_shader(const ga_shader_source& source, GLenum type)
+{
+	_handle = glCreateShader(type);
+	_source = source._pieces.empty() ? nullptr : source._pieces[0];
+	glShaderSource(_handle, GLsizei(source._pieces.size()), source._pieces.data(), source._lengths.data());
+}
+
 ga_shader::~ga_shader()
 {
 	glDeleteShader(_handle);
 }
 
 bool ga_shader::compile()
+{
+	submit();
+	return is_compiled();
+}
+
+void ga_shader::submit()
 {
 	glCompileShader(_handle);
+}
 
+bool ga_shader::is_compiled() const
+{
 	int32_t compile_status = GL_FALSE;
 	glGetShaderiv(_handle, GL_COMPILE_STATUS, &compile_status);
 	return compile_status == GL_TRUE;
@@ -120,9 +174,27 @@ void ga_program::detach(const ga_shader& shader)
 }
 
 bool ga_program::link()
+{
+	begin_link();
+	return is_linked();
+}
+
+void ga_program::begin_link()
 {
 	glLinkProgram(_handle);
+}
 
+bool ga_program::is_link_complete() const
+{
+	if (!_parallel) return true;
+
+	int32_t complete = GL_FALSE;
+	glGetProgramiv(_handle, GL_COMPLETION_STATUS_KHR, &complete);
+	return complete == GL_TRUE;
+}
+
+bool ga_program::is_linked() const
+{
 	int32_t link_status = GL_FALSE;
 	glGetProgramiv(_handle, GL_LINK_STATUS, &link_status);
 	return link_status == GL_TRUE;
@@ -148,3 +220,32 @@ void ga_program::use()
 {
 	glUseProgram(_handle);
 }
+
+bool ga_program::enable_parallel_compile(GLADloadproc get_proc)
+{
+	/* KHR and ARB share the token, and the entry point up to its suffix. */
+	typedef void (APIENTRYP max_threads_proc)(GLuint count);
+	max_threads_proc max_threads = nullptr;
+
+	int32_t extension_count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+	for (int32_t i = 0; i < extension_count && !max_threads; ++i)
+	{
+		const char* name = (const char*)glGetStringi(GL_EXTENSIONS, GLuint(i));
+		if (!name) continue;
+		if (strcmp(name, "GL_KHR_parallel_shader_compile") == 0)
+		{
+			max_threads = (max_threads_proc)get_proc("glMaxShaderCompilerThreadsKHR");
+		}
+		else if (strcmp(name, "GL_ARB_parallel_shader_compile") == 0)
+		{
+			max_threads = (max_threads_proc)get_proc("glMaxShaderCompilerThreadsARB");
+		}
+	}
+	if (!max_threads) return false;
+
+	/* As many threads as the driver likes. */
+	max_threads(0xFFFFFFFF);
+	_parallel = true;
+	return true;
+}
@@ -10,9 +10,11 @@
 */
 
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 #include <cstdint>
 #include <string>
+#include <vector>
+
+#include "ss_hash.hpp"
 
 /*
 ** Represents a shader uniform (constant).
@@ -24,6 +26,7 @@ class ga_uniform
 
 public:
 	void set(const float scalar);
+	void set(const int32_t value);
 	void set(const struct ga_vec2f& vec);
 	void set(const struct ga_vec3f& vec);
 	void set(const struct ga_vec4f& vec);
@@ -40,6 +43,24 @@ private:
 	const int32_t _location;
 };
 
+/*
+** Source text of one shader stage, gathered from pieces it does not own.
+** The pieces are handed to the driver as-is, so shared text is never concatenated.
+** @see ga_shader
+*/
+struct ga_shader_source
+{
+	void append(const char* text, uint32_t length);
+	void append(const std::string& text);
+	/* Drop all pieces, keeping the storage for reuse. */
+	void clear();
+	/* Hash of the joined text; how the text is split into pieces does not matter. */
+	uint64_t hash(uint64_t seed = SS_Hash::Seed) const;
+
+	std::vector<const char*> _pieces;
+	std::vector<int32_t> _lengths;
+};
+
 /*
 ** Represents a shader.
 ** @see ga_program
@@ -50,9 +71,13 @@ class ga_shader
 
 public:
 	ga_shader(const char* source, GLenum type);
+	ga_shader(const ga_shader_source& source, GLenum type);
 	~ga_shader();
 
 	bool compile();
+	/* Hand the source to the driver without waiting for the result. */
+	void submit();
+	bool is_compiled() const;
 
 	std::string get_compile_log() const;
 
@@ -68,6 +93,8 @@ private:
 */
 class ga_program
 {
+	friend class ga_program_binary_cache;
+
 public:
 	ga_program();
 	~ga_program();
@@ -76,6 +103,11 @@ public:
 	void detach(const ga_shader& shader);
 
 	bool link();
+	/* Start linking without waiting for the result. */
+	void begin_link();
+	/* Whether the link finished, without waiting; always true without parallel compiles. */
+	bool is_link_complete() const;
+	bool is_linked() const;
 
 	std::string get_link_log() const;
 
@@ -83,6 +115,15 @@ public:
 
 	void use();
 
+	/*
+	** Let the driver compile and link on its own threads, through KHR or ARB
+	** parallel_shader_compile. Needs a current context, and its loader for the entry point.
+	*/
+	static bool enable_parallel_compile(GLADloadproc get_proc);
+	static bool compiles_in_parallel() { return _parallel; }
+
 private:
 	uint32_t _handle;
+
+	static bool _parallel;
 };
@@ -0,0 +1,271 @@
+/*
+** RPI Game Architecture Engine
+**
+** Portions adapted from:
+** Viper Engine - Copyright (C) 2016 Velan Studios - All Rights Reserved
+**
+** This file is distributed under the MIT License. See LICENSE.txt.
+*/
+
+#include "ga_program_binary_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+/*
+** The loader is generated for GL 3.3, so the GL 4.1 / ARB_get_program_binary
+** entry points are looked up here.
+*/
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRYP ga_get_program_binary_proc)(GLuint program, GLsizei size, GLsizei* length, GLenum* format, void* binary);
+typedef void (APIENTRYP ga_program_binary_proc)(GLuint program, GLenum format, const void* binary, GLsizei length);
+typedef void (APIENTRYP ga_program_parameteri_proc)(GLuint program, GLenum name, GLint value);
+
+static ga_get_program_binary_proc ga_get_program_binary = nullptr;
+static ga_program_binary_proc ga_program_binary = nullptr;
+static ga_program_parameteri_proc ga_program_parameteri = nullptr;
+
+static const uint32_t k_binary_magic = 0x47415042; /* "GAPB" */
+static const uint32_t k_binary_version = 1;
+
+struct ga_program_binary_header
+{
+	uint32_t _magic;
+	uint32_t _version;
+	uint64_t _driver;
+	uint64_t _key;
+	uint32_t _format;
+	uint32_t _length;
+};
+
+bool ga_program_binary_cache::_enabled = false;
+std::string ga_program_binary_cache::_directory;
+uint64_t ga_program_binary_cache::_max_bytes = 0;
+uint64_t ga_program_binary_cache::_total_bytes = 0;
+uint64_t ga_program_binary_cache::_driver = 0;
+std::list<ga_program_binary_cache::entry> ga_program_binary_cache::_entries;
+bool ga_program_binary_cache::_index_dirty = false;
+uint32_t ga_program_binary_cache::_hits = 0;
+
+static uint64_t hash_gl_string(uint64_t hash, GLenum name)
+{
+	const char* str = (const char*)glGetString(name);
+	if (str)
+	{
+		hash = SS_Hash::Bytes(hash, str, strlen(str));
+	}
+	/* Separator, so "ab"+"c" and "a"+"bc" differ. */
+	return SS_Hash::Bytes(hash, "", 1);
+}
+
+bool ga_program_binary_cache::init(const std::string& directory, uint64_t max_bytes, GLADloadproc get_proc)
+{
+	ga_get_program_binary = (ga_get_program_binary_proc)get_proc("glGetProgramBinary");
+	ga_program_binary = (ga_program_binary_proc)get_proc("glProgramBinary");
+	ga_program_parameteri = (ga_program_parameteri_proc)get_proc("glProgramParameteri");
+
+	int32_t format_count = 0;
+	if (ga_get_program_binary && ga_program_binary)
+	{
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+		while (glGetError() != GL_NO_ERROR) {}
+	}
+	if (format_count <= 0)
+	{
+		std::cout << "INIT: Program binaries not supported by driver, binary cache disabled" << std::endl;
+		return false;
+	}
+
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+
+	_directory = directory;
+	_max_bytes = max_bytes;
+	_driver = hash_gl_string(SS_Hash::Seed, GL_VENDOR);
+	_driver = hash_gl_string(_driver, GL_RENDERER);
+	_driver = hash_gl_string(_driver, GL_VERSION);
+
+	/* Index lists entries most recently used first, one "key bytes" pair per line. */
+	_entries.clear();
+	_total_bytes = 0;
+	std::ifstream index(_directory + "/index");
+	std::string key_hex;
+	uint64_t bytes;
+	while (index >> key_hex >> bytes)
+	{
+		_entries.push_back(entry{ std::stoull(key_hex, nullptr, 16), bytes });
+		_total_bytes += bytes;
+	}
+
+	_enabled = true;
+	_index_dirty = false;
+	trim();
+	flush();
+	return true;
+}
+
+void ga_program_binary_cache::prepare(ga_program& program)
+{
+	if (_enabled && ga_program_parameteri)
+	{
+		ga_program_parameteri(program._handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+}
+
+bool ga_program_binary_cache::load(ga_program& program, uint64_t key)
+{
+	if (!_enabled) return false;
+
+	key = SS_Hash::Bytes(key, &_driver, sizeof(_driver));
+	auto it = _entries.begin();
+	while (it != _entries.end() && it->_key != key) { ++it; }
+	if (it == _entries.end()) return false;
+
+	std::ifstream file(get_path(key), std::ios::binary);
+	ga_program_binary_header header;
+	std::vector<char> binary;
+	if (file.read((char*)&header, sizeof(header))
+		&& header._magic == k_binary_magic && header._version == k_binary_version
+		&& header._driver == _driver && header._key == key)
+	{
+		binary.resize(header._length);
+		file.read(binary.data(), header._length);
+	}
+	if (binary.empty() || !file)
+	{
+		forget(key);
+		return false;
+	}
+
+	ga_program_binary(program._handle, GLenum(header._format), binary.data(), GLsizei(header._length));
+	int32_t link_status = GL_FALSE;
+	glGetProgramiv(program._handle, GL_LINK_STATUS, &link_status);
+	if (link_status != GL_TRUE)
+	{
+		/* Rejected, e.g. the driver was updated without changing its version string. */
+		forget(key);
+		return false;
+	}
+
+	/* The new order is saved too, so eviction on the next launch knows what was reused. */
+	if (it != _entries.begin())
+	{
+		_entries.splice(_entries.begin(), _entries, it);
+		_index_dirty = true;
+	}
+	++_hits;
+	return true;
+}
+
+void ga_program_binary_cache::store(const ga_program& program, uint64_t key)
+{
+	if (!_enabled) return;
+
+	int32_t length = 0;
+	glGetProgramiv(program._handle, GL_PROGRAM_BINARY_LENGTH, &length);
+	/* A single binary may not take more than a quarter of the budget. */
+	if (length <= 0 || uint64_t(length) > _max_bytes / 4) return;
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	ga_get_program_binary(program._handle, length, &length, &format, binary.data());
+	if (length <= 0) return;
+
+	key = SS_Hash::Bytes(key, &_driver, sizeof(_driver));
+	ga_program_binary_header header = { k_binary_magic, k_binary_version, _driver, key, uint32_t(format), uint32_t(length) };
+	std::ofstream file(get_path(key), std::ios::binary | std::ios::trunc);
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), length);
+	if (!file)
+	{
+		std::cerr << "Failed to write program binary " << get_path(key) << std::endl;
+		return;
+	}
+
+	for (auto it = _entries.begin(); it != _entries.end(); ++it)
+	{
+		if (it->_key == key)
+		{
+			_total_bytes -= it->_bytes;
+			_entries.erase(it);
+			break;
+		}
+	}
+	uint64_t bytes = sizeof(header) + uint64_t(length);
+	_entries.push_front(entry{ key, bytes });
+	_total_bytes += bytes;
+	_index_dirty = true;
+	trim();
+}
+
+void ga_program_binary_cache::flush()
+{
+	if (!_enabled || !_index_dirty) return;
+	write_index();
+	_index_dirty = false;
+}
+
+std::string ga_program_binary_cache::get_path(uint64_t key)
+{
+	char name[24];
+	snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+	return _directory + "/" + name;
+}
+
+void ga_program_binary_cache::forget(uint64_t key)
+{
+	for (auto it = _entries.begin(); it != _entries.end(); ++it)
+	{
+		if (it->_key == key)
+		{
+			_total_bytes -= it->_bytes;
+			_entries.erase(it);
+			break;
+		}
+	}
+	std::remove(get_path(key).c_str());
+	_index_dirty = true;
+}
+
+void ga_program_binary_cache::trim()
+{
+	while (_total_bytes > _max_bytes && !_entries.empty())
+	{
+		std::remove(get_path(_entries.back()._key).c_str());
+		_total_bytes -= _entries.back()._bytes;
+		_entries.pop_back();
+		_index_dirty = true;
+	}
+}
+
+void ga_program_binary_cache::write_index()
+{
+	std::ofstream index(_directory + "/index", std::ios::trunc);
+	char key_hex[17];
+	for (const entry& e : _entries)
+	{
+		snprintf(key_hex, sizeof(key_hex), "%016llx", (unsigned long long)e._key);
+		index << key_hex << " " << e._bytes << "\n";
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+/*
+** RPI Game Architecture Engine
+**
+** Portions adapted from:
+** Viper Engine - Copyright (C) 2016 Velan Studios - All Rights Reserved
+**
+** This file is distributed under the MIT License. See LICENSE.txt.
+*/
+
+#include "ga_program.h"
+
+#include <cstdint>
+#include <list>
+#include <string>
+
+/*
+** On-disk store of linked program binaries, so a relaunch can skip compiling and linking.
+** Entries are addressed by a source hash mixed with the driver's vendor, renderer and version,
+** as a binary is only valid for the driver that produced it. The least recently used
+** binaries are deleted once the directory holds more than the byte budget.
+** Does nothing if init was not called or the driver exposes no binary formats.
+** @see ga_program
+*/
+class ga_program_binary_cache
+{
+public:
+	/* Needs a current context, and its loader for the entry points. Creates the directory if missing. */
+	static bool init(const std::string& directory, uint64_t max_bytes, GLADloadproc get_proc);
+	static bool is_enabled() { return _enabled; }
+
+	/* Set before linking so the driver keeps the binary around for store. */
+	static void prepare(ga_program& program);
+
+	/*
+	** Link the program from a stored binary.
+	** A binary the driver rejects is deleted, and the program can then be linked from source.
+	*/
+	static bool load(ga_program& program, uint64_t key);
+	static void store(const ga_program& program, uint64_t key);
+	/*
+	** Write the index if entries or their order changed since the last flush.
+	** Called once per pass over the pending programs, and at shutdown.
+	*/
+	static void flush();
+
+	static uint32_t get_hit_count() { return _hits; }
+
+private:
+	struct entry
+	{
+		uint64_t _key;
+		uint64_t _bytes;
+	};
+
+	static std::string get_path(uint64_t key);
+	static void forget(uint64_t key);
+	static void trim();
+	static void write_index();
+
+	static bool _enabled;
+	static std::string _directory;
+	static uint64_t _max_bytes;
+	static uint64_t _total_bytes;
+	static uint64_t _driver;
+	static std::list<entry> _entries;
+	static bool _index_dirty;
+	static uint32_t _hits;
+};
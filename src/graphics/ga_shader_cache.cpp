@@ -0,0 +1,95 @@
+/*
+** RPI Game Architecture Engine
+**
+** Portions adapted from:
+** Viper Engine - Copyright (C) 2016 Velan Studios - All Rights Reserved
+**
+** This file is distributed under the MIT License. See LICENSE.txt.
+*/
+
+#include "ga_shader_cache.h"
+
+std::list<ga_shader_cache::entry> ga_shader_cache::_entries;
+std::unordered_multimap<uint64_t, std::list<ga_shader_cache::entry>::iterator> ga_shader_cache::_lookup;
+uint32_t ga_shader_cache::_capacity = 256;
+uint32_t ga_shader_cache::_hits = 0;
+uint32_t ga_shader_cache::_compiles = 0;
+
+std::shared_ptr<ga_shader> ga_shader_cache::get(const ga_shader_source& source, GLenum type)
+{
+	size_t length = 0;
+	for (size_t i = 0; i < source._lengths.size(); ++i)
+	{
+		length += size_t(source._lengths[i]);
+	}
+	uint64_t key = SS_Hash::Bytes(source.hash(), &type, sizeof(type));
+
+	auto range = _lookup.equal_range(key);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		auto& cached = *it->second;
+		if (cached._type == type && cached._length == length)
+		{
+			/* Most recently used entries sit at the front. */
+			_entries.splice(_entries.begin(), _entries, it->second);
+			++_hits;
+			return cached._shader;
+		}
+	}
+
+	std::shared_ptr<ga_shader> shader = std::make_shared<ga_shader>(source, type);
+	shader->submit();
+	++_compiles;
+
+	_entries.push_front(entry{ key, type, length, shader });
+	_lookup.emplace(key, _entries.begin());
+	trim();
+	return shader;
+}
+
+void ga_shader_cache::set_capacity(uint32_t capacity)
+{
+	_capacity = capacity;
+	trim();
+}
+
+void ga_shader_cache::clear()
+{
+	_lookup.clear();
+	_entries.clear();
+}
+
+void ga_shader_cache::discard(const ga_shader& shader)
+{
+	for (auto it = _entries.begin(); it != _entries.end(); ++it)
+	{
+		if (it->_shader.get() == &shader)
+		{
+			erase(it);
+			return;
+		}
+	}
+}
+
+void ga_shader_cache::erase(std::list<entry>::iterator it)
+{
+	auto range = _lookup.equal_range(it->_key);
+	for (auto lookup = range.first; lookup != range.second; ++lookup)
+	{
+		if (lookup->second == it)
+		{
+			_lookup.erase(lookup);
+			break;
+		}
+	}
+	/* Programs still holding the shader keep it alive past eviction. */
+	_entries.erase(it);
+}
+
+void ga_shader_cache::trim()
+{
+	while (_entries.size() > _capacity)
+	{
+		erase(std::prev(_entries.end()));
+	}
+}
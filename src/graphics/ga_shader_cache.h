@@ -0,0 +1,61 @@
+#pragma once
+
+/*
+** RPI Game Architecture Engine
+**
+** Portions adapted from:
+** Viper Engine - Copyright (C) 2016 Velan Studios - All Rights Reserved
+**
+** This file is distributed under the MIT License. See LICENSE.txt.
+*/
+
+#include "ga_program.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+/*
+** Process-wide store of compiled shader stages, addressed by their source text and stage.
+** Programs attach the shared objects instead of compiling their own copy; the least recently
+** requested entries are dropped past the capacity, and live on while a program still holds them.
+** Entries keep no copy of the text: a source matches an entry with the same 64-bit hash, stage
+** and length, read straight from the source's pieces.
+** @see ga_shader
+*/
+class ga_shader_cache
+{
+public:
+	/*
+	** Get the shader for the source, submitting its compile on a miss.
+	** The compile may still be running; a stage found not to compile should be discarded.
+	*/
+	static std::shared_ptr<ga_shader> get(const ga_shader_source& source, GLenum type);
+	/* Drop a stage that failed to compile, so the next request submits it again. */
+	static void discard(const ga_shader& shader);
+
+	static void set_capacity(uint32_t capacity);
+	static void clear();
+
+	static uint32_t get_hit_count() { return _hits; }
+	static uint32_t get_compile_count() { return _compiles; }
+
+private:
+	struct entry
+	{
+		uint64_t _key;
+		GLenum _type;
+		size_t _length;
+		std::shared_ptr<ga_shader> _shader;
+	};
+
+	static void erase(std::list<entry>::iterator it);
+	static void trim();
+
+	static std::list<entry> _entries;
+	static std::unordered_multimap<uint64_t, std::list<entry>::iterator> _lookup;
+	static uint32_t _capacity;
+	static uint32_t _hits;
+	static uint32_t _compiles;
+};
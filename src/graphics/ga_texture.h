@@ -11,7 +11,6 @@
 
 #include <cstdint>
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 
 /*
 ** Represents a texture object for rendering.
@@ -12,6 +12,8 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "ss_boilerplate.hpp"
+#include "ga_program_binary_cache.h"
+#include "ga_shader_cache.h"
 
 const unsigned int SCR_WIDTH = 1600;
 const unsigned int SCR_HEIGHT = 1200;
@@ -24,10 +26,16 @@ SS_Graph* DrawGraphTypePrompt() {
     SS_Graph* ret_graph = nullptr;
     ImGui::SetNextWindowSize(ImVec2(200, 200));
     ImGui::Begin("GRAPH TYPE PROMPT", nullptr, ImGuiWindowFlags_NoResize);
+    static char load_buffer[256] = "graph.ssgb";
     if (ImGui::Button("UNLIT GRAPH"))
         ret_graph = new SS_Graph(new Unlit_Boilerplate_Manager());
     else if (ImGui::Button("LIT-PBR GRAPH"))
         ret_graph = new SS_Graph(new PBR_Lit_Boilerplate_Manager());
+    ImGui::PushItemWidth(-1);
+    ImGui::InputText("###Graph File", load_buffer, 256);
+    ImGui::PopItemWidth();
+    if (not ret_graph and ImGui::Button("LOAD GRAPH FILE"))
+        ret_graph = SS_Graph::LoadGraphFile(load_buffer);
     ImGui::End();
     return ret_graph;
 }
@@ -65,6 +73,11 @@ int main()
         return -1;
     }
 
+    // build programs on driver threads where supported, so rebuilds don't stall the frame
+    ga_program::enable_parallel_compile((GLADloadproc)glfwGetProcAddress);
+    // program binaries from earlier runs, so reopened graphs skip the compile and link
+    ga_program_binary_cache::init("shader_cache", 64ull * 1024 * 1024, (GLADloadproc)glfwGetProcAddress);
+
     MakeDefaultIMGUIIniFile("imgui.ini");
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -111,6 +124,9 @@ int main()
         glfwPollEvents();
     }
     delete graph;
+    // The cached stages are GL objects, release them while the context is still alive
+    ga_shader_cache::clear();
+    ga_program_binary_cache::flush();
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -0,0 +1,171 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+#include "ss/ss_graph.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// Headless code generation: turn saved graph files into GLSL without a window or GL context.
+// No GL call is made, so the loader's function pointers are never needed.
+
+// Every heap allocation the process makes, so a warm build's real allocation count can be reported.
+    // The array forms and std::nothrow forms call these
+static size_t s_allocCount = 0;
+
+void* operator new(std::size_t size) {
+    ++s_allocCount;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+struct Watched_Graph {
+    std::string path;
+    // Modification time and size, a save within the same second still changes the size most of the time
+    long long mtime;
+    long long size;
+};
+
+void PrintUsage() {
+    std::cerr << "usage: shader_sculptor_cli [--out DIR] [--watch] [--verbose] [--save FILE] GRAPH...\n"
+                 "\tWrites GRAPH's shaders to DIR/<name>.vert.glsl and DIR/<name>.frag.glsl\n"
+                 "\t--out DIR  output directory, the current one by default\n"
+                 "\t--watch    keep running, re-writing the shaders of a graph when its file changes\n"
+                 "\t--verbose  also print which builtins were folded into literals\n"
+                 "\t--save FILE  also save the loaded graph to FILE, as binary for a .ssgb file and as text otherwise.\n"
+                 "\t             Takes a single GRAPH" << std::endl;
+}
+
+// False if the file can't be read right now, e.g. while an editor replaces it
+bool GetFileStamp(Watched_Graph& graph) {
+    struct stat st{};
+    bool found = stat(graph.path.c_str(), &st) == 0;
+    graph.mtime = found ? (long long)st.st_mtime : -1;
+    graph.size = found ? (long long)st.st_size : -1;
+    return found;
+}
+
+// File name without its directory and extension
+std::string GetStem(const std::string& path) {
+    size_t begin = path.find_last_of("/\\");
+    begin = begin == std::string::npos ? 0 : begin + 1;
+    size_t end = path.find_last_of('.');
+    if (end == std::string::npos || end < begin) end = path.size();
+    return path.substr(begin, end - begin);
+}
+
+// Whether any output of the node is connected
+bool FeedsOtherNodes(Base_GraphNode* node) {
+    for (int o = 0; o < node->GetOutputPinCount(); ++o)
+        if (node->GetOutputPin(o).HasConnections()) return true;
+    return false;
+}
+
+// Rebuild as after an edit of the connected node first in topological order, which dirties everything it feeds.
+    // The graph's writers and scratch are warm by now, so this is the allocation count of an editor's rebuild
+void MeasureWarmBuild(SS_Graph& graph) {
+    Base_GraphNode* first = nullptr;
+    for (const auto& node : graph.GetNodes()) {
+        if (not FeedsOtherNodes(node.get())) continue;
+        if (not first or node->GetTopologicalIndex() < first->GetTopologicalIndex()) first = node.get();
+    }
+    if (not first) return;
+    first->PropagateBuildDirty();
+
+    auto start = std::chrono::steady_clock::now();
+    size_t allocs = s_allocCount;
+    graph.GenerateShaderTextAndPropagate();
+    allocs = s_allocCount - allocs;
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "\twarm rebuild after editing node id=" << first->GetID() << " in " << us / 1000.0 << " ms, "
+              << allocs << " heap allocations" << std::endl;
+}
+
+bool EmitGraph(const std::string& path, const std::string& outDir, bool verbose, const std::string& savePath) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<SS_Graph> graph(SS_Graph::LoadGraphFile(path, true));
+    if (not graph) return false;
+
+    std::string stem = outDir + "/" + GetStem(path);
+    std::ofstream vert_oss(stem + ".vert.glsl");
+    std::ofstream frag_oss(stem + ".frag.glsl");
+    vert_oss << graph->GetVertCode() << std::endl;
+    frag_oss << graph->GetFragCode() << std::endl;
+    if (not vert_oss.good() or not frag_oss.good()) {
+        std::cerr << "ERROR: Couldn't write " << stem << ".vert.glsl/.frag.glsl" << std::endl;
+        return false;
+    }
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << path << " -> " << stem << ".{vert,frag}.glsl in " << us / 1000.0 << " ms" << std::endl;
+    if (verbose) std::cout << graph->GetFoldingReport() << std::flush;
+    MeasureWarmBuild(*graph);
+    if (not savePath.empty() and not graph->SaveGraphFile(savePath)) {
+        std::cerr << "ERROR: Couldn't save " << path << " to " << savePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string outDir = ".";
+    bool watch = false;
+    bool verbose = false;
+    std::string savePath;
+    std::vector<Watched_Graph> graphs;
+    for (int a = 1; a < argc; ++a) {
+        std::string arg = argv[a];
+        if (arg == "--out" and a + 1 < argc) {
+            outDir = argv[++a];
+        } else if (arg == "--watch") {
+            watch = true;
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else if (arg == "--save" and a + 1 < argc) {
+            savePath = argv[++a];
+        } else if (arg == "--help" or arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else if (arg[0] == '-') {
+            PrintUsage();
+            return 1;
+        } else {
+            graphs.push_back(Watched_Graph{ arg, -1, -1 });
+            GetFileStamp(graphs.back());
+        }
+    }
+    if (graphs.empty() or (not savePath.empty() and graphs.size() != 1)) {
+        PrintUsage();
+        return 1;
+    }
+
+    int failed = 0;
+    for (const Watched_Graph& g : graphs) {
+        if (not EmitGraph(g.path, outDir, verbose, savePath)) ++failed;
+    }
+    if (not watch) return failed == 0 ? 0 : 1;
+
+    std::cout << "Watching " << graphs.size() << " graph file(s), Ctrl-C to stop" << std::endl;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        for (Watched_Graph& g : graphs) {
+            Watched_Graph current{ g.path, -1, -1 };
+            bool found = GetFileStamp(current);
+            if (current.mtime == g.mtime and current.size == g.size) continue;
+            g = current;
+            if (found) EmitGraph(g.path, outDir, verbose, savePath);
+        }
+    }
+}
@@ -3,9 +3,17 @@
 
 
 
-std::string SS_Boilerplate_Manager::GetIntermediateResultCodeForVar(std::string& var_name) const {
+const std::string& SS_Boilerplate_Manager::GetIntermediateResultCodeForVar(SS_Name var_name) const {
+    static const std::string none;
     auto it = m_varNameToOutputCodeMap.find(var_name);
-    if (it == m_varNameToOutputCodeMap.end()) return {};
+    if (it == m_varNameToOutputCodeMap.end()) return none;
+    return it->second;
+}
+
+const std::string& SS_Boilerplate_Manager::GetIntermediateDeclareForVar(SS_Name var_name) const {
+    static const std::string none;
+    auto it = m_varNameToDeclareMap.find(var_name);
+    if (it == m_varNameToDeclareMap.end()) return none;
     return it->second;
 }
 
@@ -19,6 +27,12 @@ const std::vector<Boilerplate_Var_Data>& SS_Boilerplate_Manager::GetTerminalFrag
     return m_fragPinData;
 }
 
+SS_Boilerplate_Manager* SS_Boilerplate_Manager::MakeFromGraphTypeName(const std::string& name) {
+    if (name == "UNLIT") return new Unlit_Boilerplate_Manager();
+    if (name == "LIT-PBR") return new PBR_Lit_Boilerplate_Manager();
+    return nullptr;
+}
+
 void SS_Boilerplate_Manager::SetTerminalNodes(Terminal_Node *vertNode, Terminal_Node *frNode) {
      vertexNode = vertNode;
      fragNode = frNode;
@@ -28,17 +42,23 @@ void SS_Boilerplate_Manager::SetTerminalNodes(Terminal_Node *vertNode, Terminal_
 Unlit_Boilerplate_Manager::Unlit_Boilerplate_Manager() : SS_Boilerplate_Manager() {
     //  variables
     m_usableVars.push_back(Boilerplate_Var_Data{"TEXCOORD", GLSL_TYPE(GLSL_Float | GLSL_Vec2, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("TEXCOORD"), std::string("f_texcoord")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("TEXCOORD"), std::string("f_texcoord")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("TEXCOORD"), std::string("in vec2 f_texcoord;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"TIME", GLSL_TYPE(GLSL_Float | GLSL_Scalar, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("TIME"), std::string("u_time")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("TIME"), std::string("u_time")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("TIME"), std::string("uniform float u_time;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"WORLD NORMAL", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("WORLD NORMAL"), std::string("f_WorldNormal")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("WORLD NORMAL"), std::string("f_WorldNormal")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("WORLD NORMAL"), std::string("in vec3 f_WorldNormal;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"WORLD POSITION", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("WORLD POSITION"), std::string("f_WorldPos")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("WORLD POSITION"), std::string("f_WorldPos")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("WORLD POSITION"), std::string("in vec3 f_WorldPos;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"LOCAL NORMAL", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("LOCAL NORMAL"), std::string("f_LocalNormal")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("LOCAL NORMAL"), std::string("f_LocalNormal")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("LOCAL NORMAL"), std::string("in vec3 f_LocalNormal;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"LOCAL POSITION", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("LOCAL POSITION"), std::string("f_LocalPos")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("LOCAL POSITION"), std::string("f_LocalPos")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("LOCAL POSITION"), std::string("in vec3 f_LocalPos;")));
 
     // TERMINAL PINS
     m_vertPinData.push_back(Boilerplate_Var_Data{"N/A", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), false});
@@ -46,8 +66,8 @@ Unlit_Boilerplate_Manager::Unlit_Boilerplate_Manager() : SS_Boilerplate_Manager(
 }
 
 
-std::string Unlit_Boilerplate_Manager::GetVertInitBoilerplateDeclares() {
-    return "#version 400\n\
+void Unlit_Boilerplate_Manager::WriteVertInitBoilerplateDeclares(SS_Code_Writer& writer) {
+    writer << "#version 400\n\
     uniform mat4 u_model_mat;\n\
     uniform mat4 u_mvp;\n\
     uniform vec3 u_base_color;\n\
@@ -70,8 +90,8 @@ std::string Unlit_Boilerplate_Manager::GetVertInitBoilerplateDeclares() {
     out vec3 f_ViewNormal;";
 }
 
-std::string Unlit_Boilerplate_Manager::GetVertInitBoilerplateCode() {
-    return "\n\
+void Unlit_Boilerplate_Manager::WriteVertInitBoilerplateCode(SS_Code_Writer& writer) {
+    writer << "\n\
         f_color = in_color;\n\
         f_texcoord = in_texcoord;\n\
     \n\
@@ -85,8 +105,8 @@ std::string Unlit_Boilerplate_Manager::GetVertInitBoilerplateCode() {
         gl_Position = (vec4(in_vertex, 1.0) * u_mvp);";
 }
 
-std::string Unlit_Boilerplate_Manager::GetFragInitBoilerplateDeclares() {
-    return "#version 400\n\
+void Unlit_Boilerplate_Manager::WriteFragInitBoilerplateDeclares(SS_Code_Writer& writer) {
+    writer << "#version 400\n\
     uniform mat4 u_model_mat;\n\
     uniform mat4 u_mvp;\n\
     uniform vec3 u_base_color;\n\
@@ -104,22 +124,19 @@ std::string Unlit_Boilerplate_Manager::GetFragInitBoilerplateDeclares() {
     in vec3 f_ViewNormal;";
 }
 
-std::string Unlit_Boilerplate_Manager::GetFragInitBoilerplateCode() {
-    return "// UNLIT";
+void Unlit_Boilerplate_Manager::WriteFragInitBoilerplateCode(SS_Code_Writer& writer) {
+    writer << "// UNLIT";
 }
 
-std::string Unlit_Boilerplate_Manager::GetVertTerminalBoilerplateCode() {
-    return "";
+void Unlit_Boilerplate_Manager::WriteVertTerminalBoilerplateCode(SS_Code_Writer& writer) {
 }
-std::string Unlit_Boilerplate_Manager::GetFragTerminalBoilerplateCode() {
-    std::string terminal_str;
-    std::string n;
+void Unlit_Boilerplate_Manager::WriteFragTerminalBoilerplateCode(SS_Code_Writer& writer) {
+    writer << "\tgl_FragColor = ";
     if (fragNode->GetInputPin(0).input)
-        n = "vec4(" + fragNode->GetInputPin(0).input->get_pin_output_name() + ", 1)";
+        writer << "vec4(" << fragNode->GetInputPin(0).input->get_pin_output_name() << ", 1)";
     else
-        n = "vec4(1, 1, 1, 1)";
-
-    return "\tgl_FragColor = " + n + ";";
+        writer << "vec4(1, 1, 1, 1)";
+    writer << ';';
 }
 
 std::unique_ptr<ga_material> Unlit_Boilerplate_Manager::MakeMaterial() {
@@ -162,24 +179,33 @@ std::unique_ptr<ga_material> Unlit_Boilerplate_Manager::MakeMaterial() {
 PBR_Lit_Boilerplate_Manager::PBR_Lit_Boilerplate_Manager() : SS_Boilerplate_Manager() {
     // VARIABLES
     m_usableVars.push_back(Boilerplate_Var_Data{"TEXCOORD", GLSL_TYPE(GLSL_Float | GLSL_Vec2, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("TEXCOORD"), std::string("f_texcoord")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("TEXCOORD"), std::string("f_texcoord")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("TEXCOORD"), std::string("in vec2 f_texcoord;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"TIME", GLSL_TYPE(GLSL_Float | GLSL_Scalar, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("TIME"), std::string("u_time")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("TIME"), std::string("u_time")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("TIME"), std::string("uniform float u_time;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"OBJECT POSITION", GLSL_TYPE(GLSL_Float | GLSL_Scalar, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("OBJECT POSITION"), std::string("u_objectPos")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("OBJECT POSITION"), std::string("u_objectPos")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("OBJECT POSITION"), std::string("uniform vec3 u_objectPos;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"WORLD NORMAL", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("WORLD NORMAL"), std::string("f_WorldNormal")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("WORLD NORMAL"), std::string("f_WorldNormal")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("WORLD NORMAL"), std::string("in vec3 f_WorldNormal;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"WORLD POSITION", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("WORLD POSITION"), std::string("f_WorldPos")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("WORLD POSITION"), std::string("f_WorldPos")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("WORLD POSITION"), std::string("in vec3 f_WorldPos;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"LOCAL NORMAL", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("LOCAL NORMAL"), std::string("f_LocalNormal")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("LOCAL NORMAL"), std::string("f_LocalNormal")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("LOCAL NORMAL"), std::string("in vec3 f_LocalNormal;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"LOCAL POSITION", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("LOCAL POSITION"), std::string("f_LocalPos")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("LOCAL POSITION"), std::string("f_LocalPos")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("LOCAL POSITION"), std::string("in vec3 f_LocalPos;")));
 
     m_usableVars.push_back(Boilerplate_Var_Data{"VERTEX COLOR 1", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("VERTEX COLOR 1"), std::string("f_vertColor1")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("VERTEX COLOR 1"), std::string("f_vertColor1")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("VERTEX COLOR 1"), std::string("in vec3 f_vertColor1;")));
     m_usableVars.push_back(Boilerplate_Var_Data{"VERTEX COLOR 2", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
-    m_varNameToOutputCodeMap.insert(std::make_pair(std::string("VERTEX COLOR 2"), std::string("f_vertColor2")));
+    m_varNameToOutputCodeMap.insert(std::make_pair(SS_Name("VERTEX COLOR 2"), std::string("f_vertColor2")));
+    m_varNameToDeclareMap.insert(std::make_pair(SS_Name("VERTEX COLOR 2"), std::string("in vec3 f_vertColor2;")));
 
 
     // Terminal pins
@@ -194,8 +220,8 @@ PBR_Lit_Boilerplate_Manager::PBR_Lit_Boilerplate_Manager() : SS_Boilerplate_Mana
     m_fragPinData.push_back(Boilerplate_Var_Data{"NORMAL", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), true});
 }
 
-std::string PBR_Lit_Boilerplate_Manager::GetVertInitBoilerplateDeclares() {
-    return R"(#version 400
+void PBR_Lit_Boilerplate_Manager::WriteVertInitBoilerplateDeclares(SS_Code_Writer& writer) {
+    writer << R"(#version 400
 uniform mat4 u_model_mat;
 uniform mat4 u_mvp;
 uniform vec3 u_base_color;
@@ -221,8 +247,8 @@ out vec3 f_vertColor1;
 out vec3 f_vertColor2;)";
 }
 
-std::string PBR_Lit_Boilerplate_Manager::GetVertInitBoilerplateCode() {
-    return R"(
+void PBR_Lit_Boilerplate_Manager::WriteVertInitBoilerplateCode(SS_Code_Writer& writer) {
+    writer << R"(
     f_color = in_color;
     f_texcoord = in_texcoord;
 
@@ -237,8 +263,8 @@ std::string PBR_Lit_Boilerplate_Manager::GetVertInitBoilerplateCode() {
     f_vertColor2 = vec3(1, 1, 1);)";
 }
 
-std::string PBR_Lit_Boilerplate_Manager::GetFragInitBoilerplateDeclares() {
-    return R"(
+void PBR_Lit_Boilerplate_Manager::WriteFragInitBoilerplateDeclares(SS_Code_Writer& writer) {
+    writer << R"(
 #version 400 core
 out vec4 FragColor;
 
@@ -345,58 +371,35 @@ vec3 getNormalFromMapping(vec3 tangentNormal)
 })";
 }
 
-std::string PBR_Lit_Boilerplate_Manager::GetFragInitBoilerplateCode() {
-    return R"(// PBR-LIKE FRAGMENT CODE )";
+void PBR_Lit_Boilerplate_Manager::WriteFragInitBoilerplateCode(SS_Code_Writer& writer) {
+    writer << R"(// PBR-LIKE FRAGMENT CODE )";
 }
 
-std::string PBR_Lit_Boilerplate_Manager::GetVertTerminalBoilerplateCode() {
-    
-    std::string world_displace;
-    if (vertexNode->GetInputPin(0).input)
-        world_displace = vertexNode->GetInputPin(0).input->get_pin_output_name();
-    else  world_displace = "vec3(0, 0, 0)";
-    std::string vert_color1;
-    if (vertexNode->GetInputPin(1).input)
-        vert_color1 = vertexNode->GetInputPin(1).input->get_pin_output_name();
-    else  vert_color1 = "vec3(0, 0, 0)";
-    std::string vert_color2;
-    if (vertexNode->GetInputPin(2).input)
-        vert_color2 = vertexNode->GetInputPin(2).input->get_pin_output_name();
-    else  vert_color2 = "vec3(0, 0, 0)";
+// Write the expression connected to a terminal pin, or the fallback when unconnected
+void WriteTerminalInput(SS_Code_Writer& writer, const Terminal_Node* terminal, int pin, const char* fallback) {
+    if (terminal->GetInputPin(pin).input)
+        writer << terminal->GetInputPin(pin).input->get_pin_output_name();
+    else
+        writer << fallback;
+}
 
-    m_vertPinData.push_back(Boilerplate_Var_Data{"WORLD DISPLACEMENT", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), false});
-    m_vertPinData.push_back(Boilerplate_Var_Data{"VERTEX COLOR 1", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), false});
-    m_vertPinData.push_back(Boilerplate_Var_Data{"VERTEX COLOR 2", GLSL_TYPE(GLSL_Float | GLSL_Vec3, 1), false});
-    
-    std::string post_fix = R"(
+void PBR_Lit_Boilerplate_Manager::WriteVertTerminalBoilerplateCode(SS_Code_Writer& writer) {
+    const char* post_fix = R"(
     f_WorldPos += world_pos_displacement; // PLACEHOLDER FOR SETTING
     f_LocalPos = (vec4(f_WorldPos, 1) * inverse(u_model_mat)).xyz; // PLACEHOLDER FOR SETTING
     f_ViewPos = (vec4(f_LocalPos, 1.0) * u_mvp).xyz; // PLACEHOLDER FOR SETTING
 
     gl_Position = (vec4(f_LocalPos, 1.0) * u_mvp);)";
-    return "\nvec3 world_pos_displacement = " + world_displace + ";\n"
-        + "f_vertColor1 = " + vert_color1 + ";\n"
-        + "f_vertColor2 = " + vert_color2 + ";\n" + post_fix;
+    writer << "\nvec3 world_pos_displacement = ";
+    WriteTerminalInput(writer, vertexNode, 0, "vec3(0, 0, 0)");
+    writer << ";\nf_vertColor1 = ";
+    WriteTerminalInput(writer, vertexNode, 1, "vec3(0, 0, 0)");
+    writer << ";\nf_vertColor2 = ";
+    WriteTerminalInput(writer, vertexNode, 2, "vec3(0, 0, 0)");
+    writer << ";\n" << post_fix;
 }
 
-std::string PBR_Lit_Boilerplate_Manager::GetFragTerminalBoilerplateCode() {
-    std::string albedo, metal, rough, ao, normal;
-    if (fragNode->GetInputPin(0).input)
-        albedo = fragNode->GetInputPin(0).input->get_pin_output_name();
-    else  albedo = "vec3(1, 1, 1)";
-    if (fragNode->GetInputPin(1).input)
-        metal = fragNode->GetInputPin(1).input->get_pin_output_name();
-    else  metal = "0.5";
-    if (fragNode->GetInputPin(2).input)
-        rough = fragNode->GetInputPin(2).input->get_pin_output_name();
-    else  rough = "0.5";
-    if (fragNode->GetInputPin(3).input)
-        ao = fragNode->GetInputPin(3).input->get_pin_output_name();
-    else  ao = "1.0";
-    if (fragNode->GetInputPin(4).input)
-        normal = fragNode->GetInputPin(4).input->get_pin_output_name();
-    else  normal = "vec3(0.5, 0.5, 1.0)";
-
+void PBR_Lit_Boilerplate_Manager::WriteFragTerminalBoilerplateCode(SS_Code_Writer& writer) {
     const char* post_fix = R"(    
     vec3 N = normalize(getNormalFromMapping(ts_normal));
     vec3 V = normalize(u_eyePos - f_WorldPos);
@@ -443,11 +446,17 @@ std::string PBR_Lit_Boilerplate_Manager::GetFragTerminalBoilerplateCode() {
 
     FragColor = vec4(color, 1.0);)";
 
-    return ("\nvec3 albedo = " + albedo + ";\n"
-        + "float metallic = " + metal + ";\n"
-        + "float roughness = " + rough + ";\n"
-        + "float ao = " + ao + ";\n"
-        + "vec3 ts_normal = " + normal + ";\n") + post_fix;
+    writer << "\nvec3 albedo = ";
+    WriteTerminalInput(writer, fragNode, 0, "vec3(1, 1, 1)");
+    writer << ";\nfloat metallic = ";
+    WriteTerminalInput(writer, fragNode, 1, "0.5");
+    writer << ";\nfloat roughness = ";
+    WriteTerminalInput(writer, fragNode, 2, "0.5");
+    writer << ";\nfloat ao = ";
+    WriteTerminalInput(writer, fragNode, 3, "1.0");
+    writer << ";\nvec3 ts_normal = ";
+    WriteTerminalInput(writer, fragNode, 4, "vec3(0.5, 0.5, 1.0)");
+    writer << ";\n" << post_fix;
 }
 
 std::unique_ptr<ga_material> PBR_Lit_Boilerplate_Manager::MakeMaterial() {
@@ -16,19 +16,23 @@ public:
     virtual ~SS_Boilerplate_Manager() = default;
     // make a material of type which will effectively utilize the boilerplate code
     virtual std::unique_ptr<class ga_material> MakeMaterial() = 0;
+    // Name of the graph type, as stored in graph files
+    virtual const char* GetGraphTypeName() const = 0;
+    // Make the manager of a graph type by its name, nullptr if unknown
+    static SS_Boilerplate_Manager* MakeFromGraphTypeName(const std::string& name);
 
-    // Get the declares/header for the vertex shader
-    virtual std::string GetVertInitBoilerplateDeclares() = 0;
-    // Get the initial body code for the vertex shader
-    virtual std::string GetVertInitBoilerplateCode() = 0;
-    // Get the terminal vertex code
-    virtual std::string GetVertTerminalBoilerplateCode() = 0;
-    // Get the declares/header for the fragment shader
-    virtual std::string GetFragInitBoilerplateDeclares() = 0;
-    // Get the initial body code for the fragment shader
-    virtual std::string GetFragInitBoilerplateCode() = 0;
-    // Get the terminal fragment code
-    virtual std::string GetFragTerminalBoilerplateCode() = 0;
+    // Write the declares/header for the vertex shader
+    virtual void WriteVertInitBoilerplateDeclares(SS_Code_Writer& writer) = 0;
+    // Write the initial body code for the vertex shader
+    virtual void WriteVertInitBoilerplateCode(SS_Code_Writer& writer) = 0;
+    // Write the terminal vertex code
+    virtual void WriteVertTerminalBoilerplateCode(SS_Code_Writer& writer) = 0;
+    // Write the declares/header for the fragment shader
+    virtual void WriteFragInitBoilerplateDeclares(SS_Code_Writer& writer) = 0;
+    // Write the initial body code for the fragment shader
+    virtual void WriteFragInitBoilerplateCode(SS_Code_Writer& writer) = 0;
+    // Write the terminal fragment code
+    virtual void WriteFragTerminalBoilerplateCode(SS_Code_Writer& writer) = 0;
 
     // Get descriptions of the m_nodes which shaders can use (uniforms)
     const std::vector<Boilerplate_Var_Data>& GetUsableVariables() const;
@@ -38,7 +42,11 @@ public:
     // Get the INPUT pins required for the final fragment computations
     const std::vector<Boilerplate_Var_Data>& GetTerminalFragPinData() const;
     // Return code to display the intermediate result of a variable as the final fragment color
-    std::string GetIntermediateResultCodeForVar(std::string& var_name) const;
+    const std::string& GetIntermediateResultCodeForVar(SS_Name var_name) const;
+    // Get the declares/header shared by all intermediate fragment shaders
+    const char* GetIntermediateInitBoilerplateDeclares() const { return "#version 400\n"; }
+    // Return the declaration an intermediate fragment shader needs to read a variable
+    const std::string& GetIntermediateDeclareForVar(SS_Name var_name) const;
 
 
     // NOTE: This class does not own these m_nodes, hence the raw pointer rather than a unique pointer
@@ -47,7 +55,9 @@ public:
     Terminal_Node* GetTerminalVertexNode() { return vertexNode; }
 
 protected:
-    std::unordered_map<std::string, std::string> m_varNameToOutputCodeMap;
+    // By boilerplate variable name
+    std::unordered_map<SS_Name, std::string> m_varNameToOutputCodeMap;
+    std::unordered_map<SS_Name, std::string> m_varNameToDeclareMap;
 
     std::vector<Boilerplate_Var_Data> m_usableVars;
     std::vector<Boilerplate_Var_Data> m_vertPinData;
@@ -64,13 +74,14 @@ protected:
 class Unlit_Boilerplate_Manager : public SS_Boilerplate_Manager {
 public:
     Unlit_Boilerplate_Manager();
-    std::string GetVertInitBoilerplateDeclares() override;
-    std::string GetVertInitBoilerplateCode() override;
-    std::string GetVertTerminalBoilerplateCode() override;
-    std::string GetFragInitBoilerplateDeclares() override;
-    std::string GetFragInitBoilerplateCode() override;
-    std::string GetFragTerminalBoilerplateCode() override;
+    void WriteVertInitBoilerplateDeclares(SS_Code_Writer& writer) override;
+    void WriteVertInitBoilerplateCode(SS_Code_Writer& writer) override;
+    void WriteVertTerminalBoilerplateCode(SS_Code_Writer& writer) override;
+    void WriteFragInitBoilerplateDeclares(SS_Code_Writer& writer) override;
+    void WriteFragInitBoilerplateCode(SS_Code_Writer& writer) override;
+    void WriteFragTerminalBoilerplateCode(SS_Code_Writer& writer) override;
     std::unique_ptr<ga_material> MakeMaterial() override;
+    const char* GetGraphTypeName() const override { return "UNLIT"; }
 };
 
 /**
@@ -81,12 +92,13 @@ public:
 class PBR_Lit_Boilerplate_Manager : public SS_Boilerplate_Manager {
 public:
     PBR_Lit_Boilerplate_Manager();
-    std::string GetVertInitBoilerplateDeclares() override;
-    std::string GetVertInitBoilerplateCode() override;
-    std::string GetVertTerminalBoilerplateCode() override;
-    std::string GetFragInitBoilerplateDeclares() override;
-    std::string GetFragInitBoilerplateCode() override;
-    std::string GetFragTerminalBoilerplateCode() override;
+    void WriteVertInitBoilerplateDeclares(SS_Code_Writer& writer) override;
+    void WriteVertInitBoilerplateCode(SS_Code_Writer& writer) override;
+    void WriteVertTerminalBoilerplateCode(SS_Code_Writer& writer) override;
+    void WriteFragInitBoilerplateDeclares(SS_Code_Writer& writer) override;
+    void WriteFragInitBoilerplateCode(SS_Code_Writer& writer) override;
+    void WriteFragTerminalBoilerplateCode(SS_Code_Writer& writer) override;
     std::unique_ptr<ga_material> MakeMaterial() override;
+    const char* GetGraphTypeName() const override { return "LIT-PBR"; }
 };
 #endif
@@ -0,0 +1,232 @@
+#include "ss_canvas_renderer.hpp"
+#include "../graphics/ga_program.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+namespace {
+    // Corners of a quad as a triangle strip from gl_VertexID, with a pixel of padding for the antialiased edge
+    const char* k_rectVertSource = R"(#version 400
+layout(location = 0) in vec4 a_rect;
+layout(location = 1) in float a_rounding;
+layout(location = 2) in vec4 a_color;
+uniform mat4 u_proj;
+out vec2 v_local;
+out vec2 v_half;
+out float v_rounding;
+out vec4 v_color;
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 pos = mix(a_rect.xy - 1.0, a_rect.zw + 1.0, corner);
+    v_half = (a_rect.zw - a_rect.xy) * 0.5;
+    v_local = pos - (a_rect.xy + v_half);
+    v_rounding = min(a_rounding, min(v_half.x, v_half.y));
+    v_color = a_color;
+    gl_Position = u_proj * vec4(pos, 0.0, 1.0);
+}
+)";
+    // Coverage from the signed distance to the rounded rect
+    const char* k_rectFragSource = R"(#version 400
+in vec2 v_local;
+in vec2 v_half;
+in float v_rounding;
+in vec4 v_color;
+out vec4 o_color;
+void main() {
+    vec2 q = abs(v_local) - v_half + v_rounding;
+    float dist = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - v_rounding;
+    o_color = vec4(v_color.rgb, v_color.a * clamp(0.5 - dist, 0.0, 1.0));
+}
+)";
+    // Pairs of vertices along the curve, pushed out to either side of it
+    const char* k_wireVertSource = R"(#version 400
+layout(location = 0) in vec4 a_p01;
+layout(location = 1) in vec4 a_p23;
+layout(location = 2) in float a_thickness;
+layout(location = 3) in vec4 a_color;
+uniform mat4 u_proj;
+uniform int u_segments;
+out float v_across;
+out float v_halfWidth;
+out vec4 v_color;
+void main() {
+    float t = float(gl_VertexID >> 1) / float(u_segments);
+    float s = 1.0 - t;
+    vec2 p0 = a_p01.xy, p1 = a_p01.zw, p2 = a_p23.xy, p3 = a_p23.zw;
+    vec2 pos = s * s * s * p0 + 3.0 * s * s * t * p1 + 3.0 * s * t * t * p2 + t * t * t * p3;
+    vec2 tangent = 3.0 * s * s * (p1 - p0) + 6.0 * s * t * (p2 - p1) + 3.0 * t * t * (p3 - p2);
+    // The tangent vanishes where a control point meets its end point
+    if (dot(tangent, tangent) < 1e-6)
+        tangent = p3 - p0;
+    float len = length(tangent);
+    vec2 normal = len > 0.0 ? vec2(-tangent.y, tangent.x) / len : vec2(0.0, 1.0);
+    v_halfWidth = a_thickness * 0.5;
+    v_across = ((gl_VertexID & 1) == 0 ? -1.0 : 1.0) * (v_halfWidth + 1.0);
+    v_color = a_color;
+    gl_Position = u_proj * vec4(pos + normal * v_across, 0.0, 1.0);
+}
+)";
+    const char* k_wireFragSource = R"(#version 400
+in float v_across;
+in float v_halfWidth;
+in vec4 v_color;
+out vec4 o_color;
+void main() {
+    o_color = vec4(v_color.rgb, v_color.a * clamp(v_halfWidth + 0.5 - abs(v_across), 0.0, 1.0));
+}
+)";
+
+    void SetInstanceAttrib(GLuint location, GLint size, GLenum type, GLboolean normalized, GLsizei stride, size_t offset) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, size, type, normalized, stride, (void*)offset);
+        glVertexAttribDivisor(location, 1);
+    }
+}
+
+SS_Canvas_Renderer::SS_Canvas_Renderer() = default;
+
+SS_Canvas_Renderer::~SS_Canvas_Renderer() {
+    if (not m_isCreated) return;
+    DeleteBatch(m_rectBatch);
+    DeleteBatch(m_wireBatch);
+}
+
+void SS_Canvas_Renderer::BeginFrame(const SS_Canvas_View& view) {
+    m_rects.clear();
+    m_rectRuns.clear();
+    m_wires.clear();
+    m_wireSegments = view.IsDetailed() ? k_wireSegments : 1;
+}
+
+void SS_Canvas_Renderer::AddRect(ImVec2 min, ImVec2 max, ImU32 color, float rounding) {
+    m_rects.push_back({ min, max, rounding, color });
+}
+
+void SS_Canvas_Renderer::AddWire(ImVec2 p0, ImVec2 p1, ImVec2 p2, ImVec2 p3, ImU32 color, float thickness) {
+    m_wires.push_back({ p0, p1, p2, p3, thickness, color });
+}
+
+void SS_Canvas_Renderer::SubmitRects(ImDrawList* drawList) {
+    if (not m_rectRuns.empty())
+        m_rectRuns.back().end = m_rects.size();
+    m_rectRuns.push_back({ this, m_rects.size(), SIZE_MAX });
+    drawList->AddCallback(&SS_Canvas_Renderer::RenderRects, &m_rectRuns.back());
+    drawList->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+void SS_Canvas_Renderer::SubmitWires(ImDrawList* drawList) {
+    drawList->AddCallback(&SS_Canvas_Renderer::RenderWires, this);
+    drawList->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+void SS_Canvas_Renderer::RenderRects(const ImDrawList*, const ImDrawCmd* cmd) {
+    const auto* run = (const Rect_Run*)cmd->UserCallbackData;
+    SS_Canvas_Renderer* renderer = run->renderer;
+    const auto& rects = renderer->m_rects;
+    size_t end = std::min(run->end, rects.size());
+    if (run->begin >= end) return;
+    size_t count = end - run->begin;
+    if (not renderer->BeginBatch(renderer->m_rectBatch, cmd, rects.data() + run->begin, count * sizeof(Rect_Instance)))
+        return;
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)count);
+}
+
+void SS_Canvas_Renderer::RenderWires(const ImDrawList*, const ImDrawCmd* cmd) {
+    auto* renderer = (SS_Canvas_Renderer*)cmd->UserCallbackData;
+    const auto& wires = renderer->m_wires;
+    if (wires.empty()) return;
+    if (not renderer->BeginBatch(renderer->m_wireBatch, cmd, wires.data(), wires.size() * sizeof(Wire_Instance)))
+        return;
+    glUniform1i(renderer->m_wireBatch.program->get_uniform("u_segments").get(), renderer->m_wireSegments);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * (renderer->m_wireSegments + 1), (GLsizei)wires.size());
+}
+
+bool SS_Canvas_Renderer::BeginBatch(Batch& batch, const ImDrawCmd* cmd, const void* instances, size_t size) {
+    if (not m_isCreated)
+        CreateBatches();
+    if (not batch.program) return false;
+
+    // Same projection and clipping as the ImGui backend, the callback replaces the command's triangles
+    const ImDrawData* draw_data = ImGui::GetDrawData();
+    float l = draw_data->DisplayPos.x, r = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
+    float t = draw_data->DisplayPos.y, b = draw_data->DisplayPos.y + draw_data->DisplaySize.y;
+    const float proj[4][4] = {
+        { 2.0f / (r - l), 0.0f, 0.0f, 0.0f },
+        { 0.0f, 2.0f / (t - b), 0.0f, 0.0f },
+        { 0.0f, 0.0f, -1.0f, 0.0f },
+        { (r + l) / (l - r), (t + b) / (b - t), 0.0f, 1.0f },
+    };
+    ImVec2 scale = draw_data->FramebufferScale;
+    float fb_height = draw_data->DisplaySize.y * scale.y;
+    ImVec2 clip_min((cmd->ClipRect.x - l) * scale.x, (cmd->ClipRect.y - t) * scale.y);
+    ImVec2 clip_max((cmd->ClipRect.z - l) * scale.x, (cmd->ClipRect.w - t) * scale.y);
+    if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y) return false;
+    glScissor((int)clip_min.x, (int)(fb_height - clip_max.y), (int)(clip_max.x - clip_min.x),
+              (int)(clip_max.y - clip_min.y));
+
+    batch.program->use();
+    glUniformMatrix4fv(batch.projLocation, 1, GL_FALSE, &proj[0][0]);
+    glBindVertexArray(batch.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+    // Orphan last frame's instances rather than wait for them
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)size, instances);
+    return true;
+}
+
+void SS_Canvas_Renderer::CreateBatches() {
+    m_isCreated = true;
+    m_rectBatch.program = BuildProgram(k_rectVertSource, k_rectFragSource);
+    m_wireBatch.program = BuildProgram(k_wireVertSource, k_wireFragSource);
+
+    for (Batch* batch : { &m_rectBatch, &m_wireBatch }) {
+        glGenVertexArrays(1, &batch->vao);
+        glGenBuffers(1, &batch->vbo);
+        if (batch->program)
+            batch->projLocation = batch->program->get_uniform("u_proj").get();
+    }
+
+    glBindVertexArray(m_rectBatch.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_rectBatch.vbo);
+    GLsizei stride = sizeof(Rect_Instance);
+    SetInstanceAttrib(0, 4, GL_FLOAT, GL_FALSE, stride, offsetof(Rect_Instance, min));
+    SetInstanceAttrib(1, 1, GL_FLOAT, GL_FALSE, stride, offsetof(Rect_Instance, rounding));
+    SetInstanceAttrib(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, offsetof(Rect_Instance, color));
+
+    glBindVertexArray(m_wireBatch.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_wireBatch.vbo);
+    stride = sizeof(Wire_Instance);
+    SetInstanceAttrib(0, 4, GL_FLOAT, GL_FALSE, stride, offsetof(Wire_Instance, p0));
+    SetInstanceAttrib(1, 4, GL_FLOAT, GL_FALSE, stride, offsetof(Wire_Instance, p2));
+    SetInstanceAttrib(2, 1, GL_FLOAT, GL_FALSE, stride, offsetof(Wire_Instance, thickness));
+    SetInstanceAttrib(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, offsetof(Wire_Instance, color));
+    glBindVertexArray(0);
+}
+
+std::unique_ptr<ga_program> SS_Canvas_Renderer::BuildProgram(const char* vert_source, const char* frag_source) {
+    ga_shader vert(vert_source, GL_VERTEX_SHADER);
+    ga_shader frag(frag_source, GL_FRAGMENT_SHADER);
+    if (not vert.compile() or not frag.compile()) {
+        std::cerr << "ERROR: Couldn't compile the canvas shaders\n" << vert.get_compile_log() << frag.get_compile_log()
+                  << std::endl;
+        return nullptr;
+    }
+    std::unique_ptr<ga_program> program(new ga_program());
+    program->attach(vert);
+    program->attach(frag);
+    if (not program->link()) {
+        std::cerr << "ERROR: Couldn't link the canvas shaders\n" << program->get_link_log() << std::endl;
+        return nullptr;
+    }
+    program->detach(vert);
+    program->detach(frag);
+    return program;
+}
+
+void SS_Canvas_Renderer::DeleteBatch(Batch& batch) {
+    glDeleteVertexArrays(1, &batch.vao);
+    glDeleteBuffers(1, &batch.vbo);
+    batch.program.reset();
+}
@@ -0,0 +1,95 @@
+#ifndef SS_CANVAS_RENDERER
+#define SS_CANVAS_RENDERER
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "imgui/imgui.h"
+#include "ss_canvas_view.hpp"
+
+class ga_program;
+
+/**
+ * Instanced renderer for the shapes of the canvas, the node bodies, pins and wires.
+ * Shapes are collected as one instance each while the graph is drawn, in screen space, and rendered where the
+ * renderer's callbacks sit in an ImDrawList: each run of rects in one instanced draw and every wire in another.
+ * Rects are rounded and antialiased in the fragment shader, wires are bezier curves evaluated in the vertex shader,
+ * so neither is tessellated on the CPU. Text and images are still drawn by ImGui.
+ * GL objects are created by the first render, so shapes can be collected without GL.
+ */
+class SS_Canvas_Renderer {
+public:
+    // Segments of a curved wire
+    static const int k_wireSegments = 24;
+
+    SS_Canvas_Renderer();
+    SS_Canvas_Renderer(const SS_Canvas_Renderer&) = delete;
+    SS_Canvas_Renderer& operator=(const SS_Canvas_Renderer&) = delete;
+    ~SS_Canvas_Renderer();
+
+    // Drop the last frame's shapes, wires are straight when the view isn't detailed
+    void BeginFrame(const SS_Canvas_View& view);
+
+    // Rect from min to max, rounding is the corner radius
+    void AddRect(ImVec2 min, ImVec2 max, ImU32 color, float rounding = 0);
+    void AddCircle(ImVec2 center, float radius, ImU32 color) {
+        AddRect(ImVec2(center.x - radius, center.y - radius), ImVec2(center.x + radius, center.y + radius), color, radius);
+    }
+    // Cubic bezier from p0 to p3
+    void AddWire(ImVec2 p0, ImVec2 p1, ImVec2 p2, ImVec2 p3, ImU32 color, float thickness);
+
+    // Render, at this point of the draw list, the rects added from now until the next SubmitRects
+    void SubmitRects(ImDrawList* drawList);
+    // Render every wire of the frame at this point of the draw list
+    void SubmitWires(ImDrawList* drawList);
+
+    size_t GetRectCount() const { return m_rects.size(); }
+    size_t GetWireCount() const { return m_wires.size(); }
+
+private:
+    struct Rect_Instance {
+        ImVec2 min, max;
+        float rounding;
+        ImU32 color;
+    };
+    struct Wire_Instance {
+        ImVec2 p0, p1, p2, p3;
+        float thickness;
+        ImU32 color;
+    };
+    // Rects of one SubmitRects, end is open until the next one
+    struct Rect_Run {
+        SS_Canvas_Renderer* renderer;
+        size_t begin;
+        size_t end;
+    };
+    // Program, instance buffer and vertex array of one kind of shape
+    struct Batch {
+        std::unique_ptr<ga_program> program;
+        unsigned int vao = 0;
+        unsigned int vbo = 0;
+        int projLocation = -1;
+    };
+
+    static void RenderRects(const ImDrawList* drawList, const ImDrawCmd* cmd);
+    static void RenderWires(const ImDrawList* drawList, const ImDrawCmd* cmd);
+    // Bind the batch's program and buffers for the clip rect of the command, false if they can't be built
+    bool BeginBatch(Batch& batch, const ImDrawCmd* cmd, const void* instances, size_t size);
+    void CreateBatches();
+    static std::unique_ptr<ga_program> BuildProgram(const char* vert_source, const char* frag_source);
+    static void DeleteBatch(Batch& batch);
+
+    std::vector<Rect_Instance> m_rects;
+    // Pointed to by the callbacks, a deque so they stay in place
+    std::deque<Rect_Run> m_rectRuns;
+    std::vector<Wire_Instance> m_wires;
+    int m_wireSegments = k_wireSegments;
+
+    bool m_isCreated = false;
+    Batch m_rectBatch;
+    Batch m_wireBatch;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SS_CANVAS_VIEW
+#define SS_CANVAS_VIEW
+
+#include "imgui/imgui.h"
+
+/**
+ * Transform from the graph's canvas to the screen, screen = canvas * zoom + offset.
+ * Node layout stays in canvas units at the unzoomed font size, only drawing and input go through the view.
+ */
+struct SS_Canvas_View {
+    // Zoom limits, and the zoom below which nodes are drawn without detail
+    static constexpr float k_minZoom = 0.05f;
+    static constexpr float k_maxZoom = 2.f;
+    static constexpr float k_detailZoom = 0.5f;
+
+    ImVec2 offset = ImVec2(0, 0);
+    float zoom = 1;
+
+    ImVec2 ToScreen(ImVec2 canvas) const { return ImVec2(canvas.x * zoom + offset.x, canvas.y * zoom + offset.y); }
+    ImVec2 ToCanvas(ImVec2 screen) const { return ImVec2((screen.x - offset.x) / zoom, (screen.y - offset.y) / zoom); }
+    // Zoomed out past the detail zoom, nodes are flat rects without text or pins, and wires are straight lines
+    bool IsDetailed() const { return zoom >= k_detailZoom; }
+};
+
+#endif
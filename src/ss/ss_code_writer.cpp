@@ -0,0 +1,38 @@
+#include <cstdio>
+#include "ss_code_writer.hpp"
+
+void SS_Code_Writer::Reserve(size_t needed) {
+    if (needed <= m_capacity) return;
+    size_t capacity = m_capacity ? m_capacity : 256;
+    while (capacity < needed) capacity *= 2;
+    std::unique_ptr<char[]> data(new char[capacity]);
+    if (m_size) std::memcpy(data.get(), m_data.get(), m_size);
+    m_data = std::move(data);
+    m_capacity = capacity;
+}
+
+SS_Code_Writer& SS_Code_Writer::operator<<(SS_String_View str) {
+    if (str.size == 0) return *this;
+    Reserve(m_size + str.size);
+    std::memcpy(m_data.get() + m_size, str.data, str.size);
+    m_size += str.size;
+    return *this;
+}
+
+SS_Code_Writer& SS_Code_Writer::operator<<(char c) {
+    Reserve(m_size + 1);
+    m_data[m_size++] = c;
+    return *this;
+}
+
+SS_Code_Writer& SS_Code_Writer::operator<<(int value) {
+    char buffer[16];
+    int len = std::snprintf(buffer, sizeof(buffer), "%d", value);
+    return *this << SS_String_View(buffer, (size_t)len);
+}
+
+SS_Code_Writer& SS_Code_Writer::operator<<(float value) {
+    char buffer[32];
+    int len = std::snprintf(buffer, sizeof(buffer), "%g", value);
+    return *this << SS_String_View(buffer, (size_t)len);
+}
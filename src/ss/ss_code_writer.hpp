@@ -0,0 +1,70 @@
+#ifndef SS_CODE_WRITER
+#define SS_CODE_WRITER
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+
+/**
+ * Non-owning view of characters, used to hand identifiers and code around without copying.
+ * WARNING: views into a SS_Code_Writer are invalidated when it grows or is cleared.
+ */
+struct SS_String_View {
+    const char* data = "";
+    size_t size = 0;
+
+    SS_String_View() = default;
+    SS_String_View(const char* str) : data(str), size(std::strlen(str)) {}
+    SS_String_View(const char* str, size_t len) : data(str), size(len) {}
+    SS_String_View(const std::string& str) : data(str.data()), size(str.size()) {}
+
+    bool empty() const { return size == 0; }
+    std::string str() const { return std::string(data, size); }
+
+    bool operator==(const SS_String_View& other) const {
+        return size == other.size && std::memcmp(data, other.data, size) == 0;
+    }
+    bool operator!=(const SS_String_View& other) const { return not (*this == other); }
+};
+
+inline std::ostream& operator<<(std::ostream& os, SS_String_View view) {
+    return os.write(view.data, (std::streamsize)view.size);
+}
+
+/**
+ * Growable text arena for shader codegen.
+ * Clearing keeps the capacity, so once warmed up a writer is rebuilt without touching the heap.
+ */
+class SS_Code_Writer {
+public:
+    SS_Code_Writer() = default;
+    SS_Code_Writer(const SS_Code_Writer&) = delete;
+    SS_Code_Writer& operator=(const SS_Code_Writer&) = delete;
+
+    SS_Code_Writer& operator<<(SS_String_View str);
+    SS_Code_Writer& operator<<(char c);
+    SS_Code_Writer& operator<<(int value);
+    // Formatted like std::ostream's default, 6 significant digits
+    SS_Code_Writer& operator<<(float value);
+
+    void Clear() { m_size = 0; }
+    // Drop everything written after size
+    void Truncate(size_t size) { if (size < m_size) m_size = size; }
+
+    size_t Size() const { return m_size; }
+    bool Empty() const { return m_size == 0; }
+    const char* Data() const { return m_data ? m_data.get() : ""; }
+    SS_String_View View() const { return SS_String_View(Data(), m_size); }
+    SS_String_View View(size_t begin, size_t end) const { return SS_String_View(Data() + begin, end - begin); }
+
+private:
+    void Reserve(size_t needed);
+
+    std::unique_ptr<char[]> m_data;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+};
+
+#endif
@@ -182,3 +182,16 @@ void Parameter_Data::Draw(ParamDataGraphHook* graphHook) {
 }
 
 GLSL_TYPE Parameter_Data::GetType() const { return SS_Parser::ConstantTypeToGLSLType(m_gentype, m_type); }
+
+void Inliner_Template::AppendLiteral(const std::string& literal) {
+    if (literal.empty()) return;
+    // Adjacent literals share one span
+    if (tokens.empty() || tokens.back().kind != LITERAL)
+        tokens.push_back({ LITERAL, (unsigned int)text.size(), 0 });
+    text += literal;
+    tokens.back().length += literal.size();
+}
+
+void Inliner_Template::AppendSlot(TOKEN_KIND kind, unsigned int pin_index) {
+    tokens.push_back({ kind, pin_index, 0 });
+}
@@ -3,7 +3,9 @@
 
 #include <vector>
 #include <string>
+#include <cstring>
 #include "ss_node_types.hpp"
+#include "ss_name.hpp"
 
 // Param Data Listener, not Listener Pattern, it is passed into methods like a temporary callback
 class ParamDataGraphHook {
@@ -31,6 +33,9 @@ public:
 
     // Returns a read-only pointer to the data of the parameter. WARNING: not relocatable without copy.
     const char* GetData() const { return m_dataContainer; }
+    // Overwrite the whole data of the parameter, GetDataSize() bytes, without informing the graph
+    void SetData(const char* data) { memcpy(m_dataContainer, data, sizeof(m_dataContainer)); }
+    static constexpr unsigned GetDataSize() { return sizeof(m_dataContainer); }
     // Returns a read-only pointer to the name of the parameter. WARNING: not relocatable without copy.
     const char* GetName() const { return m_paramName; }
     // Returns the unique parameter ID of the parameter
@@ -71,13 +76,38 @@ struct Boilerplate_Var_Data {
 };
 
 /**
- *
+ * A builtin's inliner compiled once at load, literal spans interleaved with input and output slots
+ */
+struct Inliner_Template {
+    enum TOKEN_KIND : unsigned char { LITERAL, INPUT, OUTPUT };
+    struct Token {
+        TOKEN_KIND kind;
+        unsigned int index; // LITERAL: start in text, INPUT/OUTPUT: pin index
+        unsigned int length; // LITERAL only
+    };
+
+    // All literal spans back to back
+    std::string text;
+    std::vector<Token> tokens;
+    // The first output is declared and assigned the inliner's result, rather than passed to it
+    bool assigns_first_output = false;
+
+    void AppendLiteral(const std::string& literal);
+    void AppendSlot(TOKEN_KIND kind, unsigned int pin_index);
+};
+
+/**
+ * Definition of a builtin function, read once from the builtin file and never changed after.
+ * Every node built from it refers back to it by index instead of copying it
  */
 struct Builtin_Node_Data {
-    std::string _name;
-    std::string in_liner;
-    std::vector<std::pair<GLSL_TYPE,std::string> > in_vars;
-    std::vector<std::pair<GLSL_TYPE,std::string> > out_vars;
+    // Line in the builtin file, also the definition's index in the factory
+    int index = -1;
+    SS_Name _name;
+    SS_Name in_liner;
+    Inliner_Template in_liner_template;
+    std::vector<std::pair<GLSL_TYPE,SS_Name> > in_vars;
+    std::vector<std::pair<GLSL_TYPE,SS_Name> > out_vars;
 };
 
 /**
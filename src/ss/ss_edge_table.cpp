@@ -0,0 +1,82 @@
+#include "ss_edge_table.hpp"
+#include "ss_node_store.hpp"
+#include "ss_node.hpp"
+#include <cassert>
+
+void SS_Edge_Table::Link(Base_OutputPin& from, Base_InputPin& to) {
+    assert(not to.input);
+    to.input = &from;
+    m_srcNodes.push_back(from.owner->GetID());
+    m_srcPins.push_back(from.index);
+    m_dstNodes.push_back(to.owner->GetID());
+    m_dstPins.push_back(to.index);
+    ++m_liveCount;
+}
+
+bool SS_Edge_Table::Unlink(Base_InputPin& to) {
+    if (not to.input) return false;
+    // The edge is among the ones leaving the source
+    uint32_t found = UINT32_MAX;
+    ForEachOutEdge(to.input->owner->GetID(), [&](uint32_t e) {
+        if (m_dstNodes[e] == to.owner->GetID() and m_dstPins[e] == to.index) found = e;
+    });
+    to.input = nullptr;
+    assert(found != UINT32_MAX);
+    m_srcNodes[found] = -1;
+    ++m_deadCount;
+    --m_liveCount;
+    return true;
+}
+
+Base_OutputPin& SS_Edge_Table::GetOutputPin(uint32_t edge) const {
+    Base_GraphNode* node = m_nodes.Find(m_srcNodes[edge]);
+    assert(node);
+    return node->GetOutputPin(m_srcPins[edge]);
+}
+
+Base_InputPin& SS_Edge_Table::GetInputPin(uint32_t edge) const {
+    Base_GraphNode* node = m_nodes.Find(m_dstNodes[edge]);
+    assert(node);
+    return node->GetInputPin(m_dstPins[edge]);
+}
+
+bool SS_Edge_Table::HasOutEdges(const Base_OutputPin& from) {
+    bool found = false;
+    ForEachOutEdge(from.owner->GetID(), [&](uint32_t e) {
+        found |= m_srcPins[e] == from.index;
+    });
+    return found;
+}
+
+void SS_Edge_Table::Rebuild() {
+    // Compact, keeping the edges in the order they were added
+    uint32_t live = 0;
+    for (uint32_t e = 0; e < (uint32_t)m_srcNodes.size(); ++e) {
+        if (m_srcNodes[e] < 0) continue;
+        m_srcNodes[live] = m_srcNodes[e];
+        m_srcPins[live] = m_srcPins[e];
+        m_dstNodes[live] = m_dstNodes[e];
+        m_dstPins[live] = m_dstPins[e];
+        ++live;
+    }
+    m_srcNodes.resize(live);
+    m_srcPins.resize(live);
+    m_dstNodes.resize(live);
+    m_dstPins.resize(live);
+    m_deadCount = 0;
+
+    // Counting sort by source node ID, edges of a node stay in the order they were added
+    m_outOffsets.assign((size_t)m_nodes.GetIDCapacity() + 1, 0);
+    for (int src : m_srcNodes)
+        ++m_outOffsets[src + 1];
+    for (size_t k = 1; k < m_outOffsets.size(); ++k)
+        m_outOffsets[k] += m_outOffsets[k - 1];
+    m_outEdges.resize(live);
+    for (uint32_t e = 0; e < live; ++e)
+        m_outEdges[m_outOffsets[m_srcNodes[e]]++] = e;
+    // Filling shifted every offset down by one node
+    for (size_t k = m_outOffsets.size() - 1; k > 0; --k)
+        m_outOffsets[k] = m_outOffsets[k - 1];
+    m_outOffsets[0] = 0;
+    m_indexedCount = live;
+}
@@ -0,0 +1,85 @@
+#ifndef SS_EDGE_TABLE
+#define SS_EDGE_TABLE
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SS_Node_Store;
+struct Base_InputPin;
+struct Base_OutputPin;
+
+/**
+ * Every connection of a graph, as (node ID, pin index) pairs in flat arrays.
+ * An input pin has at most one source, read through its Base_InputPin::input. The table answers the other direction:
+ * the edges leaving a node, from a CSR index rebuilt lazily. Edges added or removed since the last rebuild are kept
+ * aside, and the index is rebuilt once there are more than a few of them.
+ * Link and Unlink are the only writers of Base_InputPin::input, so the pins and the table can't disagree.
+ * WARNING: edge indices change on rebuild, don't link or unlink pins while visiting edges.
+ */
+class SS_Edge_Table {
+public:
+    explicit SS_Edge_Table(const SS_Node_Store& nodes) : m_nodes(nodes) {}
+    SS_Edge_Table(const SS_Edge_Table&) = delete;
+    SS_Edge_Table& operator=(const SS_Edge_Table&) = delete;
+
+    // Connect an unconnected input pin
+    void Link(Base_OutputPin& from, Base_InputPin& to);
+    // Disconnect an input pin, false if it has no source
+    bool Unlink(Base_InputPin& to);
+    size_t Size() const { return m_liveCount; }
+
+    // EDGE ACCESS
+    int GetSourceNode(uint32_t edge) const { return m_srcNodes[edge]; }
+    int GetSourcePin(uint32_t edge) const { return m_srcPins[edge]; }
+    int GetDestNode(uint32_t edge) const { return m_dstNodes[edge]; }
+    int GetDestPin(uint32_t edge) const { return m_dstPins[edge]; }
+    Base_OutputPin& GetOutputPin(uint32_t edge) const;
+    Base_InputPin& GetInputPin(uint32_t edge) const;
+
+    // Call visit(edge) for every edge
+    template <typename Visit> void ForEachEdge(Visit visit) const {
+        for (uint32_t e = 0; e < (uint32_t)m_srcNodes.size(); ++e) {
+            if (m_srcNodes[e] >= 0) visit(e);
+        }
+    }
+    // Call visit(edge) for the edges leaving a node
+    template <typename Visit> void ForEachOutEdge(int node, Visit visit) {
+        Refresh();
+        if (node >= 0 && node + 1 < (int)m_outOffsets.size()) {
+            for (uint32_t i = m_outOffsets[node]; i < m_outOffsets[node + 1]; ++i) {
+                if (m_srcNodes[m_outEdges[i]] >= 0) visit(m_outEdges[i]);
+            }
+        }
+        for (uint32_t e = m_indexedCount; e < (uint32_t)m_srcNodes.size(); ++e) {
+            if (m_srcNodes[e] == node) visit(e);
+        }
+    }
+    // Whether any edge leaves an output pin
+    bool HasOutEdges(const Base_OutputPin& from);
+
+private:
+    // Edges added or removed since the last rebuild before the indices are rebuilt
+    static const uint32_t k_maxUnindexedEdges = 64;
+
+    void Refresh() { if ((uint32_t)m_srcNodes.size() - m_indexedCount + m_deadCount > k_maxUnindexedEdges) Rebuild(); }
+    // Drop the removed edges and rebuild the index
+    void Rebuild();
+
+    const SS_Node_Store& m_nodes;
+
+    // By edge, removed edges have a source node of -1 until the next rebuild
+    std::vector<int> m_srcNodes;
+    std::vector<int> m_srcPins;
+    std::vector<int> m_dstNodes;
+    std::vector<int> m_dstPins;
+    size_t m_liveCount = 0;
+    uint32_t m_deadCount = 0;
+
+    // CSR INDEX of the edges leaving each node, by node ID, covering the edges before m_indexedCount
+    uint32_t m_indexedCount = 0;
+    std::vector<uint32_t> m_outOffsets;
+    std::vector<uint32_t> m_outEdges;
+};
+
+#endif
@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include "ss_folding.hpp"
+
+namespace {
+    typedef bool (*Builtin_Evaluator)(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out);
+    typedef float (*Unary_Op)(float);
+    typedef float (*Binary_Op)(float, float);
+    typedef float (*Ternary_Op)(float, float, float);
+
+    // Component c of the value, scalars broadcast to every component
+    float Comp(const Folded_Value& v, int c) { return v.Count() == 1 ? v.data[0] : v.data[c]; }
+    bool Broadcasts(const Folded_Value& v, int count) { return v.Count() == 1 || v.Count() == count; }
+
+    float Dot(const Folded_Value& a, const Folded_Value& b) {
+        float sum = 0;
+        for (int c = 0; c < a.Count(); ++c) sum += a.data[c] * b.data[c];
+        return sum;
+    }
+
+    // COMPONENT-WISE OPERATIONS
+    float Add(float a, float b) { return a + b; }
+    float Sub(float a, float b) { return a - b; }
+    float Mul(float a, float b) { return a * b; }
+    float Div(float a, float b) { return a / b; }
+    float Max(float a, float b) { return std::fmax(a, b); }
+    float Min(float a, float b) { return std::fmin(a, b); }
+    float Mod(float x, float y) { return x - y * std::floor(x / y); }
+    float Pow(float x, float y) { return std::pow(x, y); }
+    float Step(float edge, float x) { return x < edge ? 0.0f : 1.0f; }
+
+    float Sqrt(float x) { return std::sqrt(x); }
+    float InverseSqrt(float x) { return 1.0f / std::sqrt(x); }
+    float Ceil(float x) { return std::ceil(x); }
+    float Floor(float x) { return std::floor(x); }
+    float Trunc(float x) { return std::trunc(x); }
+    float Round(float x) { return std::round(x); }
+    float RoundEven(float x) { return std::rint(x); } // default rounding mode is to nearest even
+    float Fract(float x) { return x - std::floor(x); }
+    float Abs(float x) { return std::fabs(x); }
+    float Sign(float x) { return (float)((x > 0.0f) - (x < 0.0f)); }
+    float Acos(float x) { return std::acos(x); }
+    float Acosh(float x) { return std::acosh(x); }
+    float Asin(float x) { return std::asin(x); }
+    float Asinh(float x) { return std::asinh(x); }
+    float Atan(float x) { return std::atan(x); }
+    float Atanh(float x) { return std::atanh(x); }
+    float Cos(float x) { return std::cos(x); }
+    float Cosh(float x) { return std::cosh(x); }
+    float Sin(float x) { return std::sin(x); }
+    float Sinh(float x) { return std::sinh(x); }
+    float Tan(float x) { return std::tan(x); }
+    float Tanh(float x) { return std::tanh(x); }
+    float Log(float x) { return std::log(x); }
+    float Log2(float x) { return std::log2(x); }
+    float Exp(float x) { return std::exp(x); }
+    float Exp2(float x) { return std::exp2(x); }
+    float Degrees(float x) { return x * 57.295779513082320876f; }
+    float Radians(float x) { return x * 0.017453292519943295770f; }
+
+    float Mix(float x, float y, float a) { return x * (1.0f - a) + y * a; }
+    float Clamp(float x, float lo, float hi) { return std::fmin(std::fmax(x, lo), hi); }
+    float Fma(float a, float b, float c) { return a * b + c; }
+    float SmoothStep(float e0, float e1, float x) {
+        float t = Clamp((x - e0) / (e1 - e0), 0.0f, 1.0f);
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    template <Unary_Op op>
+    bool Componentwise(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        int n = out[0].Count();
+        if (not Broadcasts(in[0], n)) return false;
+        for (int c = 0; c < n; ++c) out[0].data[c] = op(Comp(in[0], c));
+        return true;
+    }
+    template <Binary_Op op>
+    bool Componentwise(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        int n = out[0].Count();
+        if (not Broadcasts(in[0], n) || not Broadcasts(in[1], n)) return false;
+        for (int c = 0; c < n; ++c) out[0].data[c] = op(Comp(in[0], c), Comp(in[1], c));
+        return true;
+    }
+    template <Ternary_Op op>
+    bool Componentwise(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        int n = out[0].Count();
+        if (not Broadcasts(in[0], n) || not Broadcasts(in[1], n) || not Broadcasts(in[2], n)) return false;
+        for (int c = 0; c < n; ++c) out[0].data[c] = op(Comp(in[0], c), Comp(in[1], c), Comp(in[2], c));
+        return true;
+    }
+
+    // Copies the input components into the output, in order, as for vector constructors
+    bool Construct(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        int c = 0;
+        for (const Folded_Value& v : in)
+            for (int i = 0; i < v.Count() && c < out[0].Count(); ++i)
+                out[0].data[c++] = v.data[i];
+        return c == out[0].Count();
+    }
+
+    bool Vec3ToVec4(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        if (in[0].Count() != 3) return false;
+        std::copy(in[0].data, in[0].data + 3, out[0].data);
+        out[0].data[3] = 1.0f;
+        return true;
+    }
+
+    // GEOMETRIC OPERATIONS
+    bool Length(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        out[0].data[0] = std::sqrt(Dot(in[0], in[0]));
+        return true;
+    }
+    bool Distance(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        if (in[0].Count() != in[1].Count()) return false;
+        float sum = 0;
+        for (int c = 0; c < in[0].Count(); ++c) sum += (in[0].data[c] - in[1].data[c]) * (in[0].data[c] - in[1].data[c]);
+        out[0].data[0] = std::sqrt(sum);
+        return true;
+    }
+    bool DotProduct(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        if (in[0].Count() != in[1].Count()) return false;
+        out[0].data[0] = Dot(in[0], in[1]);
+        return true;
+    }
+    bool Cross(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        const float* x = in[0].data;
+        const float* y = in[1].data;
+        out[0].data[0] = x[1] * y[2] - y[1] * x[2];
+        out[0].data[1] = x[2] * y[0] - y[2] * x[0];
+        out[0].data[2] = x[0] * y[1] - y[0] * x[1];
+        return true;
+    }
+    bool Normalize(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        if (in[0].Count() != out[0].Count()) return false;
+        float len = std::sqrt(Dot(in[0], in[0]));
+        for (int c = 0; c < out[0].Count(); ++c) out[0].data[c] = in[0].data[c] / len;
+        return true;
+    }
+    bool Reflect(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        const Folded_Value& I = in[0];
+        const Folded_Value& N = in[1];
+        if (I.Count() != out[0].Count() || N.Count() != out[0].Count()) return false;
+        float d = Dot(N, I);
+        for (int c = 0; c < out[0].Count(); ++c) out[0].data[c] = I.data[c] - 2.0f * d * N.data[c];
+        return true;
+    }
+    bool Refract(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        const Folded_Value& I = in[0];
+        const Folded_Value& N = in[1];
+        float eta = in[2].data[0];
+        if (I.Count() != out[0].Count() || N.Count() != out[0].Count()) return false;
+        float d = Dot(N, I);
+        float k = 1.0f - eta * eta * (1.0f - d * d);
+        for (int c = 0; c < out[0].Count(); ++c)
+            out[0].data[c] = k < 0.0f ? 0.0f : eta * I.data[c] - (eta * d + std::sqrt(k)) * N.data[c];
+        return true;
+    }
+    bool FaceForward(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        const Folded_Value& N = in[0];
+        if (N.Count() != out[0].Count() || in[1].Count() != in[2].Count()) return false;
+        float s = Dot(in[2], in[1]) < 0.0f ? 1.0f : -1.0f;
+        for (int c = 0; c < out[0].Count(); ++c) out[0].data[c] = s * N.data[c];
+        return true;
+    }
+
+    // MATRIX OPERATIONS, column-major so element (col, row) is data[col * n + row]
+    bool MatVecMultiply(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        int n = in[0].length;
+        if (not in[0].matrix || in[1].Count() != n || out[0].Count() != n) return false;
+        for (int r = 0; r < n; ++r) {
+            float sum = 0;
+            for (int c = 0; c < n; ++c) sum += in[0].data[c * n + r] * in[1].data[c];
+            out[0].data[r] = sum;
+        }
+        return true;
+    }
+    bool MatMultiply(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        int n = out[0].length;
+        if (in[0].Count() != n * n || in[1].Count() != n * n) return false;
+        for (int c = 0; c < n; ++c)
+            for (int r = 0; r < n; ++r) {
+                float sum = 0;
+                for (int k = 0; k < n; ++k) sum += in[0].data[k * n + r] * in[1].data[c * n + k];
+                out[0].data[c * n + r] = sum;
+            }
+        return true;
+    }
+    bool Transpose(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        int n = out[0].length;
+        if (in[0].Count() != n * n) return false;
+        for (int c = 0; c < n; ++c)
+            for (int r = 0; r < n; ++r)
+                out[0].data[c * n + r] = in[0].data[r * n + c];
+        return true;
+    }
+    bool OuterProduct(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        int n = out[0].length;
+        if (in[0].Count() != n || in[1].Count() != n) return false;
+        for (int c = 0; c < n; ++c)
+            for (int r = 0; r < n; ++r)
+                out[0].data[c * n + r] = in[0].data[r] * in[1].data[c];
+        return true;
+    }
+    // Gauss-Jordan elimination with partial pivoting, writes the inverse if requested
+    bool Eliminate(const Folded_Value& m, float* det, float* inverse) {
+        int n = m.length;
+        double a[4][8];
+        for (int r = 0; r < n; ++r)
+            for (int c = 0; c < n; ++c) {
+                a[r][c] = m.data[c * n + r];
+                a[r][n + c] = r == c ? 1.0 : 0.0;
+            }
+        double d = 1.0;
+        for (int p = 0; p < n; ++p) {
+            int best = p;
+            for (int r = p + 1; r < n; ++r)
+                if (std::fabs(a[r][p]) > std::fabs(a[best][p])) best = r;
+            if (a[best][p] == 0.0) { d = 0.0; break; }
+            if (best != p) {
+                for (int c = 0; c < 2 * n; ++c) std::swap(a[p][c], a[best][c]);
+                d = -d;
+            }
+            d *= a[p][p];
+            double scale = 1.0 / a[p][p];
+            for (int c = 0; c < 2 * n; ++c) a[p][c] *= scale;
+            for (int r = 0; r < n; ++r) {
+                if (r == p || a[r][p] == 0.0) continue;
+                double f = a[r][p];
+                for (int c = 0; c < 2 * n; ++c) a[r][c] -= f * a[p][c];
+            }
+        }
+        if (det) *det = (float)d;
+        if (inverse) {
+            if (d == 0.0) return false;
+            for (int r = 0; r < n; ++r)
+                for (int c = 0; c < n; ++c)
+                    inverse[c * n + r] = (float)a[r][n + c];
+        }
+        return true;
+    }
+    bool Determinant(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        if (not in[0].matrix) return false;
+        return Eliminate(in[0], &out[0].data[0], nullptr);
+    }
+    bool Inverse(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        if (in[0].Count() != out[0].Count()) return false;
+        return Eliminate(in[0], nullptr, out[0].data);
+    }
+    bool YAxisRotation(const std::vector<Folded_Value>& in, std::vector<Folded_Value>& out) {
+        float c = std::cos(in[0].data[0]);
+        float s = std::sin(in[0].data[0]);
+        const float m[9] = { c, 0, s,  0, 1, 0,  -s, 0, c };
+        for (int e = 0; e < 9; ++e) out[0].data[e] = m[e];
+        return true;
+    }
+
+    struct Named_Evaluator {
+        const char* name;
+        Builtin_Evaluator evaluate;
+    };
+
+    // Keyed by the builtin node names of data/builtin_glsl_funcs.txt
+    const std::unordered_map<SS_Name, Builtin_Evaluator>& GetEvaluators() {
+        static const Named_Evaluator named[] = {
+            // arithmetic
+            { "add_(+)", Componentwise<Add> }, { "subtract_(-)", Componentwise<Sub> },
+            { "multiply_(*)", Componentwise<Mul> }, { "div_(/)", Componentwise<Div> },
+            { "multiply_scalar_(*)", Componentwise<Mul> },
+            { "mat_add_(+)", Componentwise<Add> }, { "mat_subtract_(-)", Componentwise<Sub> },
+            { "matrixComponentMult", Componentwise<Mul> },
+            { "mat_vec_multipy_(*)", MatVecMultiply }, { "mat_multiply_(*)", MatMultiply },
+            { "transpose", Transpose }, { "determinant", Determinant }, { "inverse", Inverse },
+            { "outerProduct", OuterProduct }, { "make_y_axis_rotation", YAxisRotation },
+            // construction
+            { "vec4_to_vec3", Construct }, { "vec3_to_vec4", Vec3ToVec4 },
+            { "make_vec2_alt", Construct }, { "make_vec3_alt", Construct }, { "make_vec4_alt", Construct },
+            // common
+            { "max_gen", Componentwise<Max> }, { "max_F", Componentwise<Max> },
+            { "min_gen", Componentwise<Min> }, { "min_F", Componentwise<Min> },
+            { "mod_gen", Componentwise<Mod> }, { "mod_F", Componentwise<Mod> },
+            { "pow", Componentwise<Pow> }, { "step_gen", Componentwise<Step> }, { "step", Componentwise<Step> },
+            { "mix_gen", Componentwise<Mix> }, { "mix", Componentwise<Mix> },
+            { "smoothstep_gen", Componentwise<SmoothStep> }, { "smoothstep", Componentwise<SmoothStep> },
+            { "clamp_FGen", Componentwise<Clamp> }, { "clamp_F", Componentwise<Clamp> },
+            { "MAD", Componentwise<Fma> },
+            { "sqrt", Componentwise<Sqrt> }, { "inversesqrt", Componentwise<InverseSqrt> },
+            { "ceil", Componentwise<Ceil> }, { "floor", Componentwise<Floor> }, { "trunc", Componentwise<Trunc> },
+            { "round", Componentwise<Round> }, { "roundEven", Componentwise<RoundEven> },
+            { "fract", Componentwise<Fract> }, { "abs", Componentwise<Abs> }, { "sign", Componentwise<Sign> },
+            { "rad_to_degrees", Componentwise<Degrees> }, { "degree_to_rads", Componentwise<Radians> },
+            // transcendental
+            { "acos", Componentwise<Acos> }, { "acosh", Componentwise<Acosh> },
+            { "asin", Componentwise<Asin> }, { "asinh", Componentwise<Asinh> },
+            { "atan", Componentwise<Atan> }, { "atanh", Componentwise<Atanh> },
+            { "cos", Componentwise<Cos> }, { "cosh", Componentwise<Cosh> },
+            { "sin", Componentwise<Sin> }, { "sinh", Componentwise<Sinh> },
+            { "tan", Componentwise<Tan> }, { "tanh", Componentwise<Tanh> },
+            { "log_nat", Componentwise<Log> }, { "log2", Componentwise<Log2> },
+            { "exp_e", Componentwise<Exp> }, { "exp_2", Componentwise<Exp2> },
+            // geometric
+            { "length", Length }, { "distance", Distance }, { "dot", DotProduct }, { "cross", Cross },
+            { "normalize", Normalize }, { "reflect", Reflect }, { "refract_eta", Refract },
+            { "faceforward", FaceForward },
+        };
+        static const std::unordered_map<SS_Name, Builtin_Evaluator> evaluators = [] {
+            std::unordered_map<SS_Name, Builtin_Evaluator> byName;
+            for (const Named_Evaluator& evaluator : named)
+                byName.insert(std::make_pair(SS_Name(evaluator.name), evaluator.evaluate));
+            return byName;
+        }();
+        return evaluators;
+    }
+
+    void WriteFloatLiteral(SS_Code_Writer& writer, float f) {
+        // Shortest precision which reads back to the same float
+        char buffer[32];
+        int len = 0;
+        for (int precision = 6; precision <= 9; ++precision) {
+            len = std::snprintf(buffer, sizeof(buffer), "%.*g", precision, f);
+            if (std::strtof(buffer, nullptr) == f) break;
+        }
+        writer << SS_String_View(buffer, (size_t)len);
+        // A float literal, not an int
+        if (not std::strpbrk(buffer, ".e")) writer << ".0";
+    }
+}
+
+bool SS_Folding::MakeValue(GLSL_TYPE type, Folded_Value& value) {
+    GLSL_TYPE_ENUM_BITS flags = type.type_flags;
+    // GLSL_Mat shares its bit with GLSL_TextureSampler2D, so exclude the other samplers explicitly
+    if ((flags & (GLSL_AllTypes | GLSL_TextureSampler3D | GLSL_TextureSamplerCube)) != GLSL_Float) return false;
+    if (type.arr_size > 1) return false;
+    value.type = type;
+    value.matrix = flags & GLSL_Mat;
+    switch (flags & GLSL_LenMask) {
+        case GLSL_Scalar: value.length = 1; break;
+        case GLSL_Vec2: value.length = 2; break;
+        case GLSL_Vec3: value.length = 3; break;
+        case GLSL_Vec4: value.length = 4; break;
+        default: return false; // unresolved gentype
+    }
+    if (value.matrix && value.length == 1) return false;
+    std::fill(value.data, value.data + 16, 0.0f);
+    return true;
+}
+
+bool SS_Folding::MakeDefaultValue(GLSL_TYPE type, Folded_Value& value) {
+    if (not MakeValue(type, value)) return false;
+    for (int e = 0; e < value.Count(); ++e)
+        value.data[e] = (not value.matrix || e / value.length == e % value.length) ? 1.0f : 0.0f;
+    return true;
+}
+
+bool SS_Folding::CanFoldBuiltin(SS_Name name) {
+    return GetEvaluators().count(name) > 0;
+}
+
+bool SS_Folding::EvaluateBuiltin(SS_Name name, const std::vector<Folded_Value>& ins,
+                                 std::vector<Folded_Value>& outs) {
+    auto it = GetEvaluators().find(name);
+    if (it == GetEvaluators().end() || outs.empty()) return false;
+    if (not it->second(ins, outs)) return false;
+    for (const Folded_Value& out : outs)
+        for (int e = 0; e < out.Count(); ++e)
+            if (not std::isfinite(out.data[e])) return false;
+    return true;
+}
+
+void SS_Folding::WriteValueLiteral(SS_Code_Writer& writer, const Folded_Value& value) {
+    if (value.Count() == 1) {
+        // Parenthesize negatives so they can't merge with an operator before them
+        bool negative = std::signbit(value.data[0]);
+        if (negative) writer << '(';
+        WriteFloatLiteral(writer, value.data[0]);
+        if (negative) writer << ')';
+        return;
+    }
+    writer << (value.matrix ? "mat" : "vec") << (char)('0' + value.length) << '(';
+    for (int e = 0; e < value.Count(); ++e) {
+        WriteFloatLiteral(writer, value.data[e]);
+        writer << (e + 1 == value.Count() ? ")" : ", ");
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef SS_FOLDING
+#define SS_FOLDING
+
+#include "ss_node_types.hpp"
+#include "ss_code_writer.hpp"
+#include "ss_name.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * A value known when the shader is generated: a float scalar, vector or square matrix (column-major).
+ */
+struct Folded_Value {
+    GLSL_TYPE type;
+    int length = 0; // components of a vector, or of each column of a matrix
+    bool matrix = false;
+    float data[16] = {};
+
+    int Count() const { return matrix ? length * length : length; }
+};
+
+namespace SS_Folding {
+    // Shape an empty value after a fully resolved float type, false if the type can't be folded
+    bool MakeValue(GLSL_TYPE type, Folded_Value& value);
+    // The value an unconnected input reads, matching SS_Parser::GLSLTypeToDefaultValue
+    bool MakeDefaultValue(GLSL_TYPE type, Folded_Value& value);
+    // Whether the builtin (by node name) can be evaluated on the CPU
+    bool CanFoldBuiltin(SS_Name name);
+    // Evaluate the builtin into outs, which must be shaped from the output pins.
+        // False if the inputs don't fit or the result is not finite (left to the GPU as written)
+    bool EvaluateBuiltin(SS_Name name, const std::vector<Folded_Value>& ins, std::vector<Folded_Value>& outs);
+    // Write the value as a GLSL literal, in the shortest form which reads back exactly
+    void WriteValueLiteral(SS_Code_Writer& writer, const Folded_Value& value);
+}
+
+#endif
@@ -4,9 +4,11 @@
 #include "ss_parser.hpp"
 #include "ss_node_factory.hpp"
 #include "ss_boilerplate.hpp"
+#include "ga_program_binary_cache.h"
 #include <fstream>
 #include <algorithm>
-#include <stack>
+#include <chrono>
+#include <cmath>
 
 #ifndef CMAKE_ROOT_DIR
 #define CMAKE_ROOT_DIR "./"
@@ -15,76 +17,93 @@
 /**
  * @brief Construct a new ss graph::ss graph object
  */
-SS_Graph::SS_Graph(SS_Boilerplate_Manager* bp) {
-    glGenFramebuffers(1, &m_mainFramebuffer);
-    auto error = glGetError();
-    if (error != GL_NO_ERROR) { assert(not "Failed to create Framebuffer!"); }
+SS_Graph::SS_Graph(SS_Boilerplate_Manager* bp, bool headless) : SS_Graph(bp, headless, true) {}
+
+SS_Graph::SS_Graph(SS_Boilerplate_Manager* bp, bool headless, bool build) : m_headless(headless) {
     _dragNode = nullptr;
     _dragPin = nullptr;
 
+    // Static load of node factory data, shared by every graph
+    if (not SS_Node_Factory::IsInitialized()) {
+        if (not SS_Node_Factory::InitReadBuiltinFile(std::string(CMAKE_ROOT_DIR) + "data/builtin_glsl_funcs.txt"))
+            std::cerr << "ERROR: Couldn't read the builtin function file from " << CMAKE_ROOT_DIR << "data/" << std::endl;
+        SS_Node_Factory::InitReadInBoilerplateParams(bp->GetUsableVariables());
+    }
+
     m_BPManager = std::unique_ptr<SS_Boilerplate_Manager>(bp);
+    int vertID = m_nodes.NextFreeID();
     Terminal_Node* vn = SS_Node_Factory::BuildTerminalNode(
-            m_BPManager->GetTerminalVertPinData(), ++m_currentNodeID, ImVec2(300, 300));
-    m_nodes.insert(std::make_pair(m_currentNodeID, vn));
+            m_BPManager->GetTerminalVertPinData(), vertID, ImVec2(300, 300));
+    AddNode(vertID, vn);
+    int fragID = m_nodes.NextFreeID();
     Terminal_Node* fn = SS_Node_Factory::BuildTerminalNode(
-            m_BPManager->GetTerminalFragPinData(), ++m_currentNodeID, ImVec2(300, 500));
-    m_nodes.insert(std::make_pair(m_currentNodeID, fn));
+            m_BPManager->GetTerminalFragPinData(), fragID, ImVec2(300, 500));
+    AddNode(fragID, fn);
     m_BPManager->SetTerminalNodes(vn, fn);
-    this->GenerateShaderTextAndPropagate();
+    if (build)
+        this->GenerateShaderTextAndPropagate();
 
     m_searchBuffer[0] = '\0';
     m_imgBuffer[0] = '\0';
-
-    // Static load of node factory data, NOTE: ASSUMES GRAPH SINGLETON!
-    assert(SS_Node_Factory::InitReadBuiltinFile(std::string(CMAKE_ROOT_DIR) + "data/builtin_glsl_funcs.txt"));
-    assert(SS_Node_Factory::InitReadInBoilerplateParams(bp->GetUsableVariables()));
 }
 
 SS_Graph::~SS_Graph() {
-    glDeleteFramebuffers(1, &m_mainFramebuffer);
+    if (m_mainFramebuffer != 0)
+        glDeleteFramebuffers(1, &m_mainFramebuffer);
+}
+
+
+void SS_Graph::AddNode(int id, Base_GraphNode* node) {
+    m_nodes.Insert(id, node);
+    node->SetDirtySet(&m_dirtyNodes);
+    node->SetEdgeTable(&m_edges);
 }
 
+const std::vector<Base_GraphNode*>& SS_Graph::GetDirtyNodesInOrder() {
+    m_dirtyOrder.assign(m_dirtyNodes.begin(), m_dirtyNodes.end());
+    std::sort(m_dirtyOrder.begin(), m_dirtyOrder.end(), [](const Base_GraphNode* a, const Base_GraphNode* b) {
+        return a->GetTopologicalIndex() < b->GetTopologicalIndex();
+    });
+    return m_dirtyOrder;
+}
 
 Base_GraphNode* SS_Graph::GetNode(int id) {
-    auto it = m_nodes.find(id);
-    if (it == m_nodes.end()) return nullptr;
-    return it->second.get();
+    return m_nodes.Find(id);
 }
 
 bool SS_Graph::DeleteNode(int id) {
-    auto it = m_nodes.find(id);
-    if (it == m_nodes.end()) return false;
-    if (!it->second->CanBeDeleted()) return false;
-    if (it->second.get() == _selectedNode) _selectedNode = nullptr;
-    if (it->second.get() == _dragNode) { _dragNode = nullptr; _dragPin = nullptr; }
+    Base_GraphNode* delNode = m_nodes.Find(id);
+    if (not delNode) return false;
+    if (!delNode->CanBeDeleted()) return false;
+    if (delNode == _selectedNode) _selectedNode = nullptr;
+    if (delNode == _dragNode) { _dragNode = nullptr; _dragPin = nullptr; }
 
-    auto& delNode = it->second;
     delNode->DisconnectAllPins();
 
     // If it is a parameter node, we need to remove it from the parameter->node map
     if (delNode->GetNodeType() == NODE_PARAM) {
-        auto* pn = (Param_Node*)it->second.get();
+        auto* pn = (Param_Node*)delNode;
         assert(m_paramIDsToNodeIDs.find(pn->_paramID) != m_paramIDsToNodeIDs.end());
         auto& paramNodesOfID = m_paramIDsToNodeIDs[pn->_paramID];
         assert(std::find(paramNodesOfID.begin(), paramNodesOfID.end(), pn->GetID()) != paramNodesOfID.end());
         paramNodesOfID.erase(std::find(paramNodesOfID.begin(), paramNodesOfID.end(), pn->GetID()));
     }
 
-    m_nodes.erase(it);
+    m_nodes.Erase(id);
 
     return true;
 }
 
 bool SS_Graph::DisconnectAllPinsByNodeId(int id) {
-    auto it = m_nodes.find(id);
-    if (it == m_nodes.end()) return false;
-    it->second->DisconnectAllPins();
+    Base_GraphNode* node = m_nodes.Find(id);
+    if (not node) return false;
+    node->DisconnectAllPins();
     return true;
 }
 
 void SS_Graph::InvalidateShaders() {
-    m_currentFragCode.clear();
-    m_currentVertCode.clear();
+    m_currentFragCode.Clear();
+    m_currentVertCode.Clear();
 }
 
 void SS_Graph::AddParameter() {
@@ -158,14 +177,27 @@ void SS_Graph::DrawImageLoaderWindow() {
     ImGui::End();
 }
 
+SS_Canvas_View SS_Graph::GetView() const {
+    SS_Canvas_View view;
+    view.offset = ImVec2(m_drawPosOffset.x + m_dragPosOffset.x, m_drawPosOffset.y + m_dragPosOffset.y);
+    view.zoom = m_zoom;
+    return view;
+}
+
+ImVec2 SS_Graph::GetCanvasDragDelta() const {
+    ImVec2 delta = ImGui::GetMouseDragDelta(0);
+    return ImVec2(delta.x / m_zoom, delta.y / m_zoom);
+}
+
 void SS_Graph::HandleInput() {
     //  MENU
     ImGui::SetNextWindowSize(ImVec2(250, 400));
     if (ImGui::BeginPopupContextWindow())
     {
-        ImVec2 add_pos = ImGui::GetItemRectMin();
+        ImVec2 add_pos = GetView().ToCanvas(ImGui::GetItemRectMin());
+        int nodeID = m_nodes.NextFreeID();
         if (_dragNode) {
-            _dragNode->SetDrawOldPos(_dragNode->GetDrawOldPos() + ImGui::GetMouseDragDelta(0));
+            _dragNode->SetDrawOldPos(_dragNode->GetDrawOldPos() + GetCanvasDragDelta());
         }
 
         _dragNode = nullptr;
@@ -178,9 +210,8 @@ void SS_Graph::HandleInput() {
         if (not const_node_data_list.empty()) ImGui::Text("CONSTANT:");
         for (auto nd : const_node_data_list) {
             if (ImGui::Button(nd.m_name.c_str())) {
-                Constant_Node* n = SS_Node_Factory::BuildConstantNode(nd, ++m_currentNodeID,
-                                                                  add_pos - (m_drawPosOffset + m_dragPosOffset));
-                m_nodes.insert(std::make_pair(m_currentNodeID, (Base_GraphNode*)n));
+                Constant_Node* n = SS_Node_Factory::BuildConstantNode(nd, nodeID, add_pos);
+                AddNode(nodeID, n);
                 ImGui::CloseCurrentPopup(); ImGui::EndPopup();
                 return;
             }
@@ -190,9 +221,8 @@ void SS_Graph::HandleInput() {
         if (not vec_node_data_list.empty()) ImGui::Text("VECTOR OPS:");
         for (auto nd : vec_node_data_list) {
             if (ImGui::Button(nd.m_name.c_str())) {
-                Vector_Op_Node* n = SS_Node_Factory::BuildVecOpNode(nd, ++m_currentNodeID,
-                                                                add_pos - (m_drawPosOffset + m_dragPosOffset));
-                m_nodes.insert(std::make_pair(m_currentNodeID, (Base_GraphNode*)n));
+                Vector_Op_Node* n = SS_Node_Factory::BuildVecOpNode(nd, nodeID, add_pos);
+                AddNode(nodeID, n);
                 ImGui::CloseCurrentPopup(); ImGui::EndPopup();
                 return;
             }
@@ -205,13 +235,12 @@ void SS_Graph::HandleInput() {
         for (Parameter_Data* nd : param_node_data_list) {
             if (ImGui::Button(nd->GetName() + 2)) {
                 // Add the node
-                Param_Node* n = SS_Node_Factory::BuildParamNode(nd, ++m_currentNodeID,
-                                                            add_pos - (m_drawPosOffset + m_dragPosOffset));
+                Param_Node* n = SS_Node_Factory::BuildParamNode(nd, nodeID, add_pos);
                 // Update collections
-                m_nodes.insert(std::make_pair(m_currentNodeID, n));
+                AddNode(nodeID, n);
                 if (m_paramIDsToNodeIDs.find(nd->GetID()) == m_paramIDsToNodeIDs.end())
                     m_paramIDsToNodeIDs.insert({nd->GetID(), {}});
-                m_paramIDsToNodeIDs[nd->GetID()].push_back(m_currentNodeID);
+                m_paramIDsToNodeIDs[nd->GetID()].push_back(nodeID);
                 ImGui::CloseCurrentPopup(); ImGui::EndPopup();
                 return;
             }
@@ -222,9 +251,8 @@ void SS_Graph::HandleInput() {
         for (auto nd : bp_node_data_list) {
             if (ImGui::Button(nd._name.c_str())) {
                 Boilerplate_Var_Node* n = SS_Node_Factory::BuildBoilerplateVarNode(
-                        nd, m_BPManager.get(), ++m_currentNodeID,
-                        add_pos - (m_drawPosOffset + m_dragPosOffset));
-                m_nodes.insert(std::make_pair(m_currentNodeID, (Base_GraphNode*)n));
+                        nd, m_BPManager.get(), nodeID, add_pos);
+                AddNode(nodeID, n);
                 ImGui::CloseCurrentPopup(); ImGui::EndPopup();
                 return;
             }
@@ -232,11 +260,10 @@ void SS_Graph::HandleInput() {
         // BUILTIN
         auto built_node_data_list = SS_Node_Factory::GetMatchingBuiltinNodes(std::string(m_searchBuffer));
         if (not built_node_data_list.empty()) ImGui::Text("Builtin:");
-        for (auto nd : built_node_data_list) {
-            if (ImGui::Button(nd._name.c_str())) {
-                Builtin_GraphNode* n = SS_Node_Factory::BuildBuiltinNode(nd, ++m_currentNodeID,
-                                                                         add_pos - (m_drawPosOffset + m_dragPosOffset));
-                m_nodes.insert(std::make_pair(m_currentNodeID, (Base_GraphNode*)n));
+        for (const Builtin_Node_Data* nd : built_node_data_list) {
+            if (ImGui::Button(nd->_name.c_str())) {
+                Builtin_GraphNode* n = SS_Node_Factory::BuildBuiltinNode(*nd, nodeID, add_pos);
+                AddNode(nodeID, n);
                 ImGui::CloseCurrentPopup(); ImGui::EndPopup();
                 return;
             }
@@ -247,20 +274,29 @@ void SS_Graph::HandleInput() {
         m_searchBuffer[0] = 0;
     }
 
-    // DRAGS
+    // ZOOM, keeping the canvas point under the mouse in place
     ImVec2 m_pos = ImGui::GetMousePos();
-    int hover_id = -1;
-    for (const auto& n : m_nodes) {
-        if (n.second->IsHovering(m_pos - (m_drawPosOffset + m_dragPosOffset))) {
-            hover_id = n.first;
-            break;
-        }
+    float wheel = ImGui::GetIO().MouseWheel;
+    if (wheel != 0 && ImGui::IsWindowHovered()) {
+        ImVec2 anchor = GetView().ToCanvas(m_pos);
+        m_zoom = std::min(std::max(m_zoom * std::pow(1.1f, wheel), float(SS_Canvas_View::k_minZoom)),
+                          float(SS_Canvas_View::k_maxZoom));
+        m_drawPosOffset = ImVec2(m_pos.x - anchor.x * m_zoom - m_dragPosOffset.x,
+                                 m_pos.y - anchor.y * m_zoom - m_dragPosOffset.y);
     }
 
-    Base_GraphNode* hover_node = hover_id != -1 ? m_nodes[hover_id].get() : nullptr;
-    Base_Pin* hover_pin = hover_node ? hover_node->GetHoveredPin(m_pos - (m_drawPosOffset + m_dragPosOffset)) : nullptr;
-    bool display_button_hovered = hover_node != nullptr &&
-            hover_node->IsDisplayButtonHoveredOver(m_pos - (m_drawPosOffset + m_dragPosOffset));
+    // DRAGS
+    SS_Canvas_View view = GetView();
+    ImVec2 canvas_pos = view.ToCanvas(m_pos);
+    // From the layout of the last bounds pass, the topmost node first. The selected node is drawn over the others
+    int hover_id = m_nodes.FindHovered(canvas_pos);
+    if (_selectedNode && _selectedNode->IsHovering(canvas_pos))
+        hover_id = _selectedNode->GetID();
+
+    Base_GraphNode* hover_node = hover_id != -1 ? m_nodes.Find(hover_id) : nullptr;
+    // Pins aren't drawn when zoomed out
+    Base_Pin* hover_pin = hover_node && view.IsDetailed() ? hover_node->GetHoveredPin(canvas_pos) : nullptr;
+    bool display_button_hovered = hover_node != nullptr && hover_node->IsDisplayButtonHoveredOver(canvas_pos);
     if (display_button_hovered) {
         ImGui::BeginTooltip();
         ImGui::Text("Display Intermediate");
@@ -292,7 +328,7 @@ void SS_Graph::HandleInput() {
     if (ImGui::IsMouseDragging(0)) {
         if (!m_bScreenDraggingNow) {
             if (_dragNode) {
-                _dragNode->SetDrawPos(_dragNode->GetDrawOldPos() + ImGui::GetMouseDragDelta(0));
+                _dragNode->SetDrawPos(_dragNode->GetDrawOldPos() + GetCanvasDragDelta());
             }
         } else {
             m_dragPosOffset = ImGui::GetMouseDragDelta(0);
@@ -306,7 +342,7 @@ void SS_Graph::HandleInput() {
             }
         }
         if (_dragNode)
-            _dragNode->SetDrawOldPos(_dragNode->GetDrawOldPos() + ImGui::GetMouseDragDelta(0));
+            _dragNode->SetDrawOldPos(_dragNode->GetDrawOldPos() + GetCanvasDragDelta());
 
         if (_dragPin && hover_pin) {
             if (_dragPin->bInput && !hover_pin->bInput)
@@ -330,6 +366,7 @@ void SS_Graph::DrawControlsWindow() {
 LEFT CLICK : SELECT AND DRAG NODE OR PIN
 RIGHT CLICK: OPEN NODE ADD MENU; USE SEARCH BAR
 SPACEBAR : ACTIVATE CAMERA DRAG (HOLD LEFT CLICK)
+MOUSE WHEEL: ZOOM
 DELETE: DELETE HOVERED NODE OR PIN)");
     ImGui::End();
 }
@@ -348,13 +385,20 @@ bool SS_Graph::DrawSavingWindow() {
         std::ofstream frag_oss(std::string(m_saveBuffer) + "/" + std::string(saveFragStr));
         std::ofstream vert_oss(std::string(m_saveBuffer) + "/" + std::string(saveVertStr));
         if (frag_oss.good() and vert_oss.good()) {
-            frag_oss << m_currentFragCode << std::endl;
-            vert_oss << m_currentVertCode << std::endl;
+            frag_oss << m_currentFragCode.View() << std::endl;
+            vert_oss << m_currentVertCode.View() << std::endl;
         } else {
             std::cerr << "WARNING: Couldn't save to " << m_saveBuffer << ".\n\tThis directory might not exist." << std::endl;
         }
         bReturn = false;
     }
+    // The graph itself, to be reopened or turned into code by shader_sculptor_cli
+    ImGui::InputText("GRAPH NAME", m_graphSaveBuffer, 128);
+    if (ImGui::Button("SAVE GRAPH FILE")) {
+        if (not SaveGraphFile(std::string(m_saveBuffer) + "/" + std::string(m_graphSaveBuffer)))
+            std::cerr << "WARNING: Couldn't save to " << m_saveBuffer << ".\n\tThis directory might not exist." << std::endl;
+        bReturn = false;
+    }
     if (ImGui::Button("CLOSE WITH SAVE"))
         bReturn = false;
     ImGui::End();
@@ -393,17 +437,26 @@ void SS_Graph::DrawMenuButtons() {
             sprintf(m_saveBuffer, ".");
             sprintf(m_saveBuffer + 128, "frag.glsl");
             sprintf(m_saveBuffer + 192, "vert.glsl");
+            sprintf(m_graphSaveBuffer, "graph.ssgb");
         }
         HandleMenuTooltip("Save out the source code");
         if (ImGui::Button("SHOW CONTROLS"))
             m_bControlsUp = !m_bControlsUp;
         if (ImGui::Button("SHOW CREDITS"))
             m_bCreditsUp = !m_bCreditsUp;
+        bool uberPreview = m_uberPreview;
+        if (ImGui::Checkbox("SINGLE PREVIEW PROGRAM", &uberPreview))
+            SetUberPreview(uberPreview);
+        HandleMenuTooltip("Preview every node from one program, one compile per build instead of one per node");
+        int pendingPrograms = (int)m_pendingProgramNodes.size() + (m_pendingUberCube ? 1 : 0);
+        if (pendingPrograms > 0)
+            ImGui::Text("BUILDING %d PROGRAMS", pendingPrograms);
     }
     ImGui::EndMenuBar();
 }
 
 void SS_Graph::Draw() {
+    LoadPendingImages();
     if (m_bIsSaving)
         m_bIsSaving = DrawSavingWindow();
     if (m_bCreditsUp)
@@ -413,14 +466,32 @@ void SS_Graph::Draw() {
     DrawNodeContextWindow();
     DrawImageLoaderWindow();
     DrawControlsWindow();
-    
-    // drawn m_nodes, may want to decrease view size
-    for (const auto& n_it : m_nodes) {
-        if (n_it.second->GetHasDisplayUp())
-            n_it.second->DrawIntermediateResult(m_mainFramebuffer, m_paramDatas);
+
+    if (m_areProgramsDeferred) {
+        ConstructTerminalOrders();
+        BuildIntermediatePrograms(m_vertOrder, m_fragOrder);
     }
+    PollPendingPrograms();
 
+    if (m_mainFramebuffer == 0) {
+        glGenFramebuffers(1, &m_mainFramebuffer);
+        if (glGetError() != GL_NO_ERROR) { assert(not "Failed to create Framebuffer!"); }
+    }
     const auto& io = ImGui::GetIO();
+    // Previews in view of the last layout, the smaller they are drawn the lower the mip they render to
+    SS_Canvas_View view = GetView();
+    m_nodes.FindVisible(view.ToCanvas(ImVec2(0, 0)), view.ToCanvas(io.DisplaySize), m_visibleNodes);
+    for (size_t n : m_visibleNodes) {
+        if (not m_nodes.HasDisplayUp(n)) continue;
+        Base_GraphNode* node = m_nodes.At(n);
+        float drawn_size = node->GetDrawRectSize().x * view.zoom;
+        int mip = 0;
+        while (mip + 1 < NODE_PREVIEW_MIPS && (NODE_PREVIEW_SIZE >> (mip + 1)) >= drawn_size)
+            ++mip;
+        bool shared = m_uberPreview and node->GetNodeType() != NODE_TERMINAL;
+        node->DrawIntermediateResult(m_mainFramebuffer, m_paramDatas, shared ? m_uberCube.get() : nullptr, mip);
+    }
+
     ImGui::SetNextWindowPos(ImVec2(0, 0));
     ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x, io.DisplaySize.y));
     ImGui::Begin("SHADER SCULPTOR", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove
@@ -430,15 +501,62 @@ void SS_Graph::Draw() {
     if (!m_bIsSaving)
         HandleInput();
     ImDrawList* dl = ImGui::GetWindowDrawList(); 
-    for (auto& p_node : m_nodes)
-        p_node.second->SetBounds(1);
-    for (auto& p_node : m_nodes)
-        p_node.second->Draw(dl, m_drawPosOffset + m_dragPosOffset, p_node.second.get() == _selectedNode);
-    for (auto& p_node : m_nodes)
-        p_node.second->DrawOutputConnects(dl, m_drawPosOffset + m_dragPosOffset);
+    // A new font size changes the layout of every node, otherwise only the nodes marked since the last frame change
+    if (ImGui::GetFontSize() != m_layoutFontSize) {
+        m_layoutFontSize = ImGui::GetFontSize();
+        for (const auto& node : m_nodes)
+            node->InvalidateLayout();
+    }
+    m_nodes.SyncChangedLayouts();
+    // Only what overlaps the window is submitted, in canvas space
+    view = GetView();
+    ImVec2 view_min = view.ToCanvas(ImGui::GetWindowPos());
+    ImVec2 view_max = view.ToCanvas(ImGui::GetWindowPos() + ImGui::GetWindowSize());
+    m_nodes.FindVisible(view_min, view_max, m_visibleNodes);
+    // Node shapes render under the node text, wires over everything. Nodes overlapping another, and the selected
+    // node, are drawn after the rest, each over its own shapes, so no other node's text lands on their bodies
+    m_nodes.SplitOverlapping(m_visibleNodes, m_layeredNodes);
+    Base_GraphNode* top_node = _dragNode ? _dragNode : _selectedNode;
+    for (std::vector<size_t>* nodes : { &m_visibleNodes, &m_layeredNodes }) {
+        auto it = std::find_if(nodes->begin(), nodes->end(), [&](size_t n) { return m_nodes.At(n) == top_node; });
+        if (it == nodes->end()) continue;
+        size_t top = *it;
+        nodes->erase(it);
+        m_layeredNodes.push_back(top);
+        break;
+    }
+    // Past the limit, the nodes drawn first share the shapes of the rest
+    if (m_layeredNodes.size() > k_maxLayeredNodes) {
+        size_t shared = m_layeredNodes.size() - k_maxLayeredNodes;
+        m_visibleNodes.insert(m_visibleNodes.end(), m_layeredNodes.begin(), m_layeredNodes.begin() + shared);
+        m_layeredNodes.erase(m_layeredNodes.begin(), m_layeredNodes.begin() + shared);
+    }
+    m_canvasRenderer.BeginFrame(view);
+    m_canvasRenderer.SubmitRects(dl);
+    for (size_t n : m_visibleNodes) {
+        Base_GraphNode* node = m_nodes.At(n);
+        node->Draw(dl, m_canvasRenderer, view, node == _selectedNode);
+    }
+    for (size_t n : m_layeredNodes) {
+        Base_GraphNode* node = m_nodes.At(n);
+        m_canvasRenderer.SubmitRects(dl);
+        node->Draw(dl, m_canvasRenderer, view, node == _selectedNode);
+    }
+    m_edges.ForEachEdge([&](uint32_t e) {
+        // A wire stays within the bounds of its two nodes, widened by its control points
+        ImVec2 o_min, o_max, i_min, i_max;
+        m_nodes.GetBounds(m_edges.GetSourceNode(e), o_min, o_max);
+        m_nodes.GetBounds(m_edges.GetDestNode(e), i_min, i_max);
+        const float wire_pad = 55;
+        if (std::max(o_max.x, i_max.x) + wire_pad < view_min.x || std::min(o_min.x, i_min.x) - wire_pad > view_max.x
+            || std::max(o_max.y, i_max.y) + wire_pad < view_min.y || std::min(o_min.y, i_min.y) - wire_pad > view_max.y)
+            return;
+        Base_GraphNode::DrawConnection(m_canvasRenderer, m_edges.GetOutputPin(e), m_edges.GetInputPin(e), view);
+    });
+    m_canvasRenderer.SubmitWires(dl);
     if (_dragPin) {
         float r;
-        dl->AddLine(_dragPin->GetPinPos(3, 2, &r) + m_drawPosOffset + m_dragPosOffset, ImGui::GetMousePos(), 0xffffffff);
+        dl->AddLine(view.ToScreen(_dragPin->GetPinPos(3, 2, &r)), ImGui::GetMousePos(), 0xffffffff);
     }
 
     ImGui::End();
@@ -455,33 +573,48 @@ void SS_Graph::DrawNodeContextWindow() const {
             
             if (const_node->_data_type == SS_Float) {
                 auto* f_ptr = (float*)const_node->_data;
+                bool edited = false;
                 switch (const_node->_data_gen) {
-                    case SS_Scalar: ImGui::InputFloat("Input Scalar", f_ptr); break;
-                    case SS_Vec2: ImGui::InputFloat2("Input Vec2", f_ptr); break;
-                    case SS_Vec3: ImGui::InputFloat3("Input Vec3", f_ptr); break;
-                    case SS_Vec4: ImGui::InputFloat4("Input Vec4", f_ptr); break;
+                    case SS_Scalar: edited = ImGui::InputFloat("Input Scalar", f_ptr); break;
+                    case SS_Vec2: edited = ImGui::InputFloat2("Input Vec2", f_ptr); break;
+                    case SS_Vec3: edited = ImGui::InputFloat3("Input Vec3", f_ptr); break;
+                    case SS_Vec4: edited = ImGui::InputFloat4("Input Vec4", f_ptr); break;
 
                     case SS_Mat2:
-                        ImGui::InputFloat2("Input Row 1", f_ptr);
-                        ImGui::InputFloat2("Input Row 2", f_ptr + 2); break;
+                        edited |= ImGui::InputFloat2("Input Row 1", f_ptr);
+                        edited |= ImGui::InputFloat2("Input Row 2", f_ptr + 2); break;
                     case SS_Mat3:
-                        ImGui::InputFloat3("Input Row 1", f_ptr);
-                        ImGui::InputFloat3("Input Row 2", f_ptr + 3);
-                        ImGui::InputFloat3("Input Row 3", f_ptr + 6); break;
+                        edited |= ImGui::InputFloat3("Input Row 1", f_ptr);
+                        edited |= ImGui::InputFloat3("Input Row 2", f_ptr + 3);
+                        edited |= ImGui::InputFloat3("Input Row 3", f_ptr + 6); break;
                     case SS_Mat4:
-                        ImGui::InputFloat4("Input Row 1", f_ptr);
-                        ImGui::InputFloat4("Input Row 2", f_ptr + 4);
-                        ImGui::InputFloat4("Input Row 3", f_ptr + 8);
-                        ImGui::InputFloat4("Input Row 4", f_ptr + 12); break;
+                        edited |= ImGui::InputFloat4("Input Row 1", f_ptr);
+                        edited |= ImGui::InputFloat4("Input Row 2", f_ptr + 4);
+                        edited |= ImGui::InputFloat4("Input Row 3", f_ptr + 8);
+                        edited |= ImGui::InputFloat4("Input Row 4", f_ptr + 12); break;
                     case SS_MAT:
                         ImGui::Text("WARNING:\nNon-square matrix context not yet supported.");
                         break;
                 }
+                // The constant's value is baked into the code of every node reading it
+                if (edited)
+                    const_node->PropagateBuildDirty();
             }
         } else {
             ImGui::Text("Non-Constant Node");
+            if (_selectedNode->GetNodeType() == NODE_BUILTIN and _selectedNode->HasConstantOutputs()) {
+                ImGui::Text("Folded into a literal:");
+                for (int o = 0; o < _selectedNode->GetOutputPinCount(); ++o) {
+                    SS_String_View literal = _selectedNode->GetCachedOutput(o);
+                    ImGui::TextUnformatted(literal.data, literal.data + literal.size);
+                }
+            }
         }
     }
+    if (not m_foldingReport.Empty()) {
+        ImGui::Separator();
+        ImGui::TextUnformatted(m_foldingReport.Data(), m_foldingReport.Data() + m_foldingReport.Size());
+    }
     ImGui::End();
 }
 
@@ -489,78 +622,227 @@ void SS_Graph::DrawNodeContextWindow() const {
 /************************************************
  * *********************CONSTRUCTION **************************/
 
-int GetInDegreesOfNode(Base_GraphNode* node) {
-    int pinCount = 0;
-    for (int ip = 0; ip < node->GetInputPinCount(); ++ip) {
-        if (node->GetInputPin(ip).input) pinCount++;
-    }
-    return pinCount;
-}
-
-std::unordered_map<Base_GraphNode*, int> GetInDegreesOfAllNodes(Base_GraphNode* root) {
-    std::unordered_map<Base_GraphNode*, int> inDegrees;
-    std::stack<Base_GraphNode*> processStack;
-    processStack.push(root);
-    inDegrees.insert({root, GetInDegreesOfNode(root)});
-    while (not processStack.empty()) {
-        Base_GraphNode* node = processStack.top();
-        processStack.pop();
-        for (int i = 0; i < node->GetInputPinCount(); i++) {
-            if (not node->GetInputPin(i).input) continue;
-            Base_GraphNode* inputNode = node->GetInputPin(i).input->owner;
-            if (inDegrees.find(inputNode) == inDegrees.end()) {
-                inDegrees.insert({inputNode, GetInDegreesOfNode(inputNode)});
-                processStack.push(inputNode);
-            }
+void SS_Graph::ConstructTopologicalOrder(Base_GraphNode* root, std::vector<Base_GraphNode*>& order) {
+    // Collect root and every node feeding it, each stamped with this collection's stamp when first reached
+    m_orderStamps.resize((size_t)m_nodes.GetIDCapacity(), 0);
+    uint32_t stamp = ++m_orderStamp;
+    order.assign(1, root);
+    m_orderStamps[root->GetID()] = stamp;
+    for (size_t n = 0; n < order.size(); ++n) {
+        for (int i = 0; i < order[n]->GetInputPinCount(); ++i) {
+            const Base_OutputPin* input = order[n]->GetInputPin(i).input;
+            if (not input or m_orderStamps[input->owner->GetID()] == stamp) continue;
+            m_orderStamps[input->owner->GetID()] = stamp;
+            order.push_back(input->owner);
         }
     }
-    return inDegrees;
+    // The topological indices are kept up to date as pins connect, so they only need sorting
+    std::sort(order.begin(), order.end(), [](const Base_GraphNode* a, const Base_GraphNode* b) {
+        return a->GetTopologicalIndex() < b->GetTopologicalIndex();
+    });
+}
+
+void SS_Graph::ConstructTerminalOrders() {
+    ConstructTopologicalOrder(m_BPManager->GetTerminalVertexNode(), m_vertOrder);
+    ConstructTopologicalOrder(m_BPManager->GetTerminalFragNode(), m_fragOrder);
 }
 
-std::vector<Base_GraphNode*> SS_Graph::ConstructTopologicalOrder(Base_GraphNode* root) {
-    std::vector<Base_GraphNode*> topOrder;
-    std::stack<Base_GraphNode*> processStack;
+// Index of a node in an order from ConstructTopologicalOrder, order.size() if it isn't part of it
+size_t FindInOrder(const std::vector<Base_GraphNode*>& order, const Base_GraphNode* node) {
+    auto it = std::lower_bound(order.begin(), order.end(), node, [](const Base_GraphNode* a, const Base_GraphNode* b) {
+        return a->GetTopologicalIndex() < b->GetTopologicalIndex();
+    });
+    return it != order.end() and *it == node ? size_t(it - order.begin()) : order.size();
+}
 
-    // Collect our starting elements
-    std::unordered_map<Base_GraphNode*, int> inDegrees = GetInDegreesOfAllNodes(root);
-    for (const auto& kv : inDegrees)
-        if (kv.second == 0) processStack.push(kv.first);
+// Collect the order indices of a node and its transitive inputs, sorted so they keep topological order
+void CollectInputCone(size_t nodeIndex, const std::vector<Base_GraphNode*>& order,
+                      std::vector<size_t>& coneStamps, std::vector<size_t>& cone) {
+    // The cone is its own worklist, nodes are appended as they are reached
+    cone.assign(1, nodeIndex);
+    coneStamps[nodeIndex] = nodeIndex;
+    for (size_t c = 0; c < cone.size(); ++c) {
+        size_t n = cone[c];
+        for (int i = 0; i < order[n]->GetInputPinCount(); ++i) {
+            if (not order[n]->GetInputPin(i).input) continue;
+            size_t in = FindInOrder(order, order[n]->GetInputPin(i).input->owner);
+            assert(in < order.size());
+            if (coneStamps[in] == nodeIndex) continue;
+            coneStamps[in] = nodeIndex;
+            cone.push_back(in);
+        }
+    }
+    std::sort(cone.begin(), cone.end());
+}
 
-    // Add based on processed dependencies
-    while (not processStack.empty()) {
-        Base_GraphNode* node = processStack.top();
-        processStack.pop();
-        topOrder.push_back(node);
+void SS_Graph::CompileIntermediateCodeForNode(const std::vector<Base_GraphNode*>& order, const SS_Code_Writer& body,
+                                              const std::vector<size_t>& statementEnds, const std::vector<size_t>& cone) {
+    Base_GraphNode* node = order[cone.back()];
+    m_intermediateVertSource.clear();
+    m_intermediateVertSource.append(m_currentVertCode.Data(), (uint32_t)m_currentVertCode.Size());
+    m_intermediateFragSource.clear();
 
-        for (int o = 0; o < node->GetOutputPinCount(); ++o) {
-            for (const auto& conn : node->GetOutputPin(o).output) {
-                Base_GraphNode* inputNode = conn->owner;
-                inDegrees[inputNode] -= 1;
-                if (inDegrees[inputNode] <= 0)
-                    processStack.push(inputNode);
+    if (node->GetOutputPinCount() == 0 or node->GetCachedOutput(0).empty()) {
+        m_intermediateFragSource.append(m_currentFragCode.Data(), (uint32_t)m_currentFragCode.Size());
+    } else {
+        // Header and tail share one writer, written in full before any piece points into it
+        SS_Code_Writer& frame = m_intermediateFrame;
+        frame.Clear();
+        // -- header, only the variables and parameters the cone reads
+        std::vector<const std::string*> declaredVars;
+        std::vector<int> declaredParams;
+        frame << m_BPManager->GetIntermediateInitBoilerplateDeclares();
+        for (size_t n : cone) {
+            const Base_GraphNode* coneNode = order[n];
+            if (coneNode->GetNodeType() == NODE_BOILER_VAR) {
+                const std::string& declare = m_BPManager->GetIntermediateDeclareForVar(coneNode->GetName());
+                if (std::find(declaredVars.begin(), declaredVars.end(), &declare) != declaredVars.end()) continue;
+                declaredVars.push_back(&declare);
+                frame << declare << '\n';
+            } else if (coneNode->GetNodeType() == NODE_PARAM) {
+                int paramID = ((const Param_Node*)coneNode)->_paramID;
+                if (std::find(declaredParams.begin(), declaredParams.end(), paramID) != declaredParams.end()) continue;
+                declaredParams.push_back(paramID);
+                for (const auto& p_data : m_paramDatas) {
+                    if (p_data->GetID() != paramID) continue;
+                    frame << "uniform ";
+                    SS_Parser::WriteGLSLType(frame, p_data->GetType());
+                    frame << ' ' << p_data->GetName() << ";\n";
+                }
             }
         }
+        frame << "\nvoid main() {\n";
+        size_t headerEnd = frame.Size();
+        // -- tail, display the node's first output
+        frame << "gl_FragColor = ";
+        SS_Parser::WriteOutputAsColor(frame, node->GetCachedOutput(0), node->GetOutputPin(0).type);
+        frame << ";\n}\n";
+
+        m_intermediateFragSource.append(frame.Data(), (uint32_t)headerEnd);
+        // -- main body, gathered from the shared body
+        for (size_t n : cone) {
+            size_t begin = n == 0 ? 0 : statementEnds[n - 1];
+            m_intermediateFragSource.append(body.Data() + begin, (uint32_t)(statementEnds[n] - begin));
+        }
+        m_intermediateFragSource.append(frame.Data() + headerEnd, (uint32_t)(frame.Size() - headerEnd));
+    }
+    node->CompileIntermediateCode(m_BPManager->MakeMaterial(), m_intermediateVertSource, m_intermediateFragSource);
+    SS_Node_Handle handle = m_nodes.GetHandle(node->GetID());
+    if (std::find(m_pendingProgramNodes.begin(), m_pendingProgramNodes.end(), handle) == m_pendingProgramNodes.end()) {
+        if (node->GetNodeType() == NODE_TERMINAL)
+            m_pendingProgramNodes.push_front(handle);
+        else
+            m_pendingProgramNodes.push_back(handle);
     }
-    return topOrder;
 }
 
-void SS_Graph::SetIntermediateCodeForNode(std::string intermedCode, Base_GraphNode* node) {
-    std::string output = node->RequestOutput(0);
-    if (output.empty()) {
-        node->SetShaderCode(m_currentFragCode, m_currentVertCode);
-    } else {
-        intermedCode += "gl_FragColor = ";
-        intermedCode += SS_Parser::ConvertOutputToColorStr(output, node->GetOutputPin(0).type) + ";\n}\n";
-        node->SetShaderCode(intermedCode, m_currentVertCode);
+void SS_Graph::PollPendingPrograms() {
+    // Polling driver-side compiles never waits, so the budget only holds back compiles done here
+    const auto budget = std::chrono::milliseconds(4);
+    const auto start = std::chrono::steady_clock::now();
+    bool linked;
+    if (m_pendingUberCube && m_pendingUberCube->_material->poll(linked)) {
+        // A program that fails to link is dropped, the current one keeps drawing
+        if (linked) m_uberCube = std::move(m_pendingUberCube);
+        else m_pendingUberCube.reset();
+        for (SS_Node_Handle handle : m_pendingUberNodes) {
+            Base_GraphNode* node = m_nodes.Find(handle);
+            if (node) node->FinishSharedIntermediateProgram(linked);
+        }
+        m_pendingUberNodes.clear();
+    }
+    auto it = m_pendingProgramNodes.begin();
+    while (it != m_pendingProgramNodes.end()) {
+        if (not ga_program::compiles_in_parallel() && std::chrono::steady_clock::now() - start > budget) break;
+        // Deleted nodes are skipped, even once another node has their ID
+        Base_GraphNode* node = m_nodes.Find(*it);
+        if (not node || node->PollIntermediateProgram())
+            it = m_pendingProgramNodes.erase(it);
+        else
+            ++it;
     }
+    // Binaries stored or reused by this pass are indexed once
+    ga_program_binary_cache::flush();
 }
 
-void WriteParameterData(std::ostringstream& oss, const std::vector<std::unique_ptr<Parameter_Data>>& params) {
+void WriteParameterData(SS_Code_Writer& writer, const std::vector<std::unique_ptr<Parameter_Data>>& params) {
     for (const auto& p_data : params) {
-        oss << "uniform ";
-        oss << SS_Parser::GLSLTypeToString(p_data->GetType());
-        oss << " ";
-        oss << p_data->GetName() << ";\n";
+        writer << "uniform ";
+        SS_Parser::WriteGLSLType(writer, p_data->GetType());
+        writer << ' ' << p_data->GetName() << ";\n";
+    }
+}
+
+// List which builtins were evaluated into literals by this build, nothing if none were
+void WriteFoldingReport(SS_Code_Writer& report, const std::vector<const Base_GraphNode*>& foldedNodes) {
+    report.Clear();
+    if (foldedNodes.empty()) return;
+    report << "Constant folding: " << (int)foldedNodes.size() << " node(s) replaced by literals\n";
+    for (const Base_GraphNode* node : foldedNodes) {
+        report << "\tNode " << node->GetName() << ", id=" << node->GetID() << " ->";
+        for (int o = 0; o < node->GetOutputPinCount(); ++o)
+            report << ' ' << node->GetCachedOutput(o);
+        report << '\n';
+    }
+}
+
+// Check a structural hash hit: same kind of node, with every input read from the same canonical output.
+    // canonical holds the node each statement of the order repeats, or the statement's own node
+bool IsSameComputation(const Base_GraphNode* node, const Base_GraphNode* other, const std::vector<Base_GraphNode*>& order,
+                       const std::vector<const Base_GraphNode*>& canonical) {
+    if (node->GetNodeType() != other->GetNodeType() || node->GetName() != other->GetName()) return false;
+    if (node->GetInputPinCount() != other->GetInputPinCount()) return false;
+    if (node->GetOutputPinCount() != other->GetOutputPinCount()) return false;
+    for (int i = 0; i < node->GetInputPinCount(); ++i) {
+        const Base_OutputPin* a = node->GetInputPin(i).input;
+        const Base_OutputPin* b = other->GetInputPin(i).input;
+        if (not a || not b) {
+            if (a != b || node->GetInputPin(i).type.type_flags != other->GetInputPin(i).type.type_flags) return false;
+            continue;
+        }
+        size_t aIndex = FindInOrder(order, a->owner);
+        size_t bIndex = FindInOrder(order, b->owner);
+        const Base_GraphNode* aOwner = aIndex < order.size() ? canonical[aIndex] : a->owner;
+        const Base_GraphNode* bOwner = bIndex < order.size() ? canonical[bIndex] : b->owner;
+        // Constants and other expression-only nodes compare by their output text
+        if (a->index != b->index || (aOwner != bOwner && a->get_pin_output_name() != b->get_pin_output_name()))
+            return false;
+    }
+    return true;
+}
+
+// Write the statements of the order, aliasing the outputs of any node that repeats an earlier computation.
+    // hashes and canonical are scratch, kept by the caller so a warm build doesn't allocate
+void WriteMainStatementsWithCSE(SS_Code_Writer& os, const std::vector<Base_GraphNode*>& order,
+                                std::vector<std::pair<uint64_t, size_t>>& hashes,
+                                std::vector<const Base_GraphNode*>& canonical) {
+    // Sorted by hash and then order index, so the first entry of a hash is the earliest node computing it
+    hashes.clear();
+    for (size_t n = 0; n < order.size(); ++n) {
+        if (not order[n]->GetCachedCode().empty() && order[n]->GetOutputPinCount() > 0)
+            hashes.push_back(std::make_pair(order[n]->GetStructuralHash(), n));
+    }
+    std::sort(hashes.begin(), hashes.end());
+    canonical.assign(order.begin(), order.end());
+    for (size_t n = 0; n < order.size(); ++n) {
+        Base_GraphNode* node = order[n];
+        os << "\t";
+        bool aliased = false;
+        if (not node->GetCachedCode().empty() && node->GetOutputPinCount() > 0) {
+            auto first = std::lower_bound(hashes.begin(), hashes.end(), std::make_pair(node->GetStructuralHash(), size_t(0)));
+            const Base_GraphNode* other = order[first->second];
+            if (other != node && IsSameComputation(node, other, order, canonical)) {
+                canonical[n] = other;
+                for (int o = 0; o < node->GetOutputPinCount(); ++o) {
+                    SS_Parser::WriteGLSLType(os, node->GetOutputPin(o).type);
+                    os << ' ' << node->GetCachedOutput(o) << " = " << other->GetCachedOutput(o) << "; ";
+                }
+                os << " // Node " << node->GetName() << ", id=" << node->GetID() << ", same as id=" << other->GetID() << '\n';
+                aliased = true;
+            }
+        }
+        if (not aliased)
+            os << node->GetCachedCode() << "  // Node " << node->GetName() << ", id=" << node->GetID() << '\n';
     }
 }
 
@@ -568,85 +850,199 @@ void SS_Graph::SetFinalShaderTextByConstructOrders(const std::vector<Base_GraphN
                                                    const std::vector<Base_GraphNode*>& fragOrder) {
     // MAXIMAL VERTEX BUILD
     {
-        std::ostringstream vertIss;
+        SS_Code_Writer& vertIss = m_currentVertCode;
+        vertIss.Clear();
         // -- header
-        vertIss << m_BPManager->GetVertInitBoilerplateDeclares() << '\n';
+        m_BPManager->WriteVertInitBoilerplateDeclares(vertIss);
+        vertIss << '\n';
         WriteParameterData(vertIss, m_paramDatas);
         // -- main body
-        vertIss << "\nvoid main() {\n" << m_BPManager->GetVertInitBoilerplateCode() << '\n';
-        for (Base_GraphNode* node: vertOrder) {
-            vertIss << "\t" << node->ProcessForCode() << "  // Node " << node->GetName() << ", id=" << node->GetID() << '\n';
-        }
-        vertIss << m_BPManager->GetVertTerminalBoilerplateCode() << "\n}\n";
-        m_currentVertCode = vertIss.str();
+        vertIss << "\nvoid main() {\n";
+        m_BPManager->WriteVertInitBoilerplateCode(vertIss);
+        vertIss << '\n';
+        WriteMainStatementsWithCSE(vertIss, vertOrder, m_cseHashes, m_cseCanonical);
+        m_BPManager->WriteVertTerminalBoilerplateCode(vertIss);
+        vertIss << "\n}\n";
     }
     // MAXIMAL FRAG BUILD
     {
-        std::ostringstream fragIss;
+        SS_Code_Writer& fragIss = m_currentFragCode;
+        fragIss.Clear();
         // -- header
-        fragIss << m_BPManager->GetFragInitBoilerplateDeclares() << '\n';
+        m_BPManager->WriteFragInitBoilerplateDeclares(fragIss);
+        fragIss << '\n';
         WriteParameterData(fragIss, m_paramDatas);
         // -- main body
-        fragIss << "\nvoid main() {\n" << m_BPManager->GetFragInitBoilerplateCode() << '\n';
-        for (Base_GraphNode* node: fragOrder) {
-            fragIss << "\t" << node->ProcessForCode() << "  // Node " << node->GetName() << ", id=" << node->GetID() << '\n';
-        }
-        fragIss << m_BPManager->GetFragTerminalBoilerplateCode() << "\n}\n";
-        m_currentFragCode = fragIss.str();
+        fragIss << "\nvoid main() {\n";
+        m_BPManager->WriteFragInitBoilerplateCode(fragIss);
+        fragIss << '\n';
+        WriteMainStatementsWithCSE(fragIss, fragOrder, m_cseHashes, m_cseCanonical);
+        m_BPManager->WriteFragTerminalBoilerplateCode(fragIss);
+        fragIss << "\n}\n";
     }
 }
 
 void SS_Graph::PropagateIntermediateVertexCodeToNodes(const std::vector<Base_GraphNode*>& vertOrder) {
-    std::ostringstream vertIss;
-    // -- header
-    vertIss << m_BPManager->GetFragInitBoilerplateDeclares() << '\n';
-    WriteParameterData(vertIss, m_paramDatas);
-    // -- main body
-    vertIss << "\nvoid main() {\n" << m_BPManager->GetFragInitBoilerplateCode() << '\n';
-    for (Base_GraphNode* node: vertOrder) {
-        vertIss << "\t" << node->ProcessForCode() << "  // Node " << node->GetName() << ", id=" << node->GetID() << '\n';
-        SetIntermediateCodeForNode(vertIss.str(), node);
+    PropagateIntermediateCodeToNodes(vertOrder);
+}
+
+void SS_Graph::PropagateIntermediateFragmentCodeToNodes(const std::vector<Base_GraphNode*>& fragOrder) {
+    PropagateIntermediateCodeToNodes(fragOrder);
+}
+
+void SS_Graph::PropagateIntermediateCodeToNodes(const std::vector<Base_GraphNode*>& order) {
+    // -- shared body holding every statement once, in topological order
+    SS_Code_Writer& bodyIss = m_intermediateBody;
+    bodyIss.Clear();
+    std::vector<size_t>& statementEnds = m_statementEnds;
+    statementEnds.clear();
+    for (size_t n = 0; n < order.size(); ++n) {
+        bodyIss << '\t' << order[n]->GetCachedCode() << "  // Node " << order[n]->GetName() << ", id=" << order[n]->GetID() << '\n';
+        statementEnds.push_back(bodyIss.Size());
+    }
+    // -- compile, only the programs of dirty nodes are relinked; each gathers just its input cone
+    std::vector<size_t>& dirty = m_dirtyIndices;
+    dirty.clear();
+    for (Base_GraphNode* node : GetDirtyNodesInOrder()) {
+        size_t n = FindInOrder(order, node);
+        if (n < order.size() and node->NeedsIntermediateProgram()) dirty.push_back(n);
     }
-    // -- compile
-    for (Base_GraphNode* node: vertOrder) {
-        node->CompileIntermediateCode(m_BPManager->MakeMaterial());
+    // The terminal ends its order, but is submitted first so the full material is ready soonest
+    if (not dirty.empty() && order[dirty.back()]->GetNodeType() == NODE_TERMINAL)
+        std::rotate(dirty.begin(), dirty.end() - 1, dirty.end());
+    m_coneStamps.assign(order.size(), order.size());
+    for (size_t n : dirty) {
+        CollectInputCone(n, order, m_coneStamps, m_cone);
+        CompileIntermediateCodeForNode(order, bodyIss, statementEnds, m_cone);
     }
 }
 
-void SS_Graph::PropagateIntermediateFragmentCodeToNodes(const std::vector<Base_GraphNode*>& fragOrder) {
-    std::ostringstream fragIss;
+void SS_Graph::CompileUberPreviewProgram(const std::vector<Base_GraphNode*>& vertOrder,
+                                         const std::vector<Base_GraphNode*>& fragOrder) {
+    // Both orders with each node once, a node's inputs always precede it in one of them
+    bool dirty = false;
+    for (const Base_GraphNode* node : m_dirtyNodes) {
+        dirty |= node->NeedsIntermediateProgram() and node->GetNodeType() != NODE_TERMINAL
+                 and (FindInOrder(vertOrder, node) < vertOrder.size() or FindInOrder(fragOrder, node) < fragOrder.size());
+    }
+    if (not dirty) return;
+    std::vector<Base_GraphNode*> nodes;
+    std::unordered_set<const Base_GraphNode*> seen;
+    for (const std::vector<Base_GraphNode*>* order : { &vertOrder, &fragOrder }) {
+        for (Base_GraphNode* node : *order) {
+            if (node->GetNodeType() == NODE_TERMINAL or not seen.insert(node).second) continue;
+            nodes.push_back(node);
+        }
+    }
+    if (nodes.empty()) return;
+
+    SS_Code_Writer& frame = m_intermediateFrame;
+    frame.Clear();
     // -- header
-    fragIss << m_BPManager->GetFragInitBoilerplateDeclares() << '\n';
-    WriteParameterData(fragIss, m_paramDatas);
-    // -- main body
-    fragIss << "\nvoid main() {\n" << m_BPManager->GetFragInitBoilerplateCode() << '\n';
-    for (Base_GraphNode* node: fragOrder) {
-        fragIss << "\t" << node->ProcessForCode() << "  // Node " << node->GetName() << ", id=" << node->GetID() << '\n';
-        SetIntermediateCodeForNode(fragIss.str(), node);
+    std::vector<const std::string*> declaredVars;
+    frame << m_BPManager->GetIntermediateInitBoilerplateDeclares();
+    for (const Base_GraphNode* node : nodes) {
+        if (node->GetNodeType() != NODE_BOILER_VAR) continue;
+        const std::string& declare = m_BPManager->GetIntermediateDeclareForVar(node->GetName());
+        if (std::find(declaredVars.begin(), declaredVars.end(), &declare) != declaredVars.end()) continue;
+        declaredVars.push_back(&declare);
+        frame << declare << '\n';
+    }
+    WriteParameterData(frame, m_paramDatas);
+    frame << "uniform int u_preview_node;\n";
+    // -- main body, every statement once
+    frame << "\nvoid main() {\n";
+    for (const Base_GraphNode* node : nodes)
+        frame << '\t' << node->GetCachedCode() << "  // Node " << node->GetName() << ", id=" << node->GetID() << '\n';
+    // -- tail, display the first output of the selected node
+    frame << "\tswitch (u_preview_node) {\n";
+    for (const Base_GraphNode* node : nodes) {
+        if (node->GetOutputPinCount() == 0 or node->GetCachedOutput(0).empty()) continue;
+        frame << "\tcase " << node->GetID() << ": gl_FragColor = ";
+        SS_Parser::WriteOutputAsColor(frame, node->GetCachedOutput(0), node->GetOutputPin(0).type);
+        frame << "; break;\n";
     }
-    // -- compile
-    for (Base_GraphNode* node: fragOrder) {
-        node->CompileIntermediateCode(m_BPManager->MakeMaterial());
+    frame << "\tdefault: gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0); break;\n\t}\n}\n";
+
+    m_intermediateVertSource.clear();
+    m_intermediateVertSource.append(m_currentVertCode.Data(), (uint32_t)m_currentVertCode.Size());
+    m_intermediateFragSource.clear();
+    m_intermediateFragSource.append(frame.Data(), (uint32_t)frame.Size());
+    // A newer build replaces one still in flight, the current program draws until then
+    m_pendingUberCube.reset(new ga_cube_component(m_intermediateVertSource, m_intermediateFragSource,
+                                                  m_BPManager->MakeMaterial()));
+    m_pendingUberNodes.clear();
+    for (Base_GraphNode* node : nodes) {
+        node->SubmitSharedIntermediateProgram();
+        m_pendingUberNodes.push_back(m_nodes.GetHandle(node->GetID()));
+    }
+}
+
+void SS_Graph::SetUberPreview(bool enabled) {
+    m_uberPreview = enabled;
+    for (auto& node : m_nodes) {
+        if (node->GetNodeType() == NODE_TERMINAL) continue;
+        node->InvalidateIntermediateProgram();
+        if (enabled) node->ReleaseIntermediateProgram();
+    }
+    if (not enabled) {
+        m_uberCube.reset();
+        m_pendingUberCube.reset();
+        m_pendingUberNodes.clear();
     }
+    GenerateShaderTextAndPropagate();
 }
 
 void SS_Graph::GenerateShaderTextAndPropagate() {
-    Terminal_Node* vn = m_BPManager->GetTerminalVertexNode();
-    Terminal_Node* fn = m_BPManager->GetTerminalFragNode();
-    std::vector<Base_GraphNode*> vertOrder = ConstructTopologicalOrder(vn);
-    std::vector<Base_GraphNode*> fragOrder = ConstructTopologicalOrder(fn);
-    if (vertOrder.empty() or fragOrder.empty()) {
+    ConstructTerminalOrders();
+    if (m_vertOrder.empty() or m_fragOrder.empty()) {
         assert(not "ERROR");
     }
+    GenerateShaderText(m_vertOrder, m_fragOrder);
+    if (m_headless) return;
+    BuildIntermediatePrograms(m_vertOrder, m_fragOrder);
+}
+
+void SS_Graph::GenerateShaderText(const std::vector<Base_GraphNode*>& vertOrder,
+                                  const std::vector<Base_GraphNode*>& fragOrder) {
+    // Only dirty nodes regenerate their code, in order so their inputs are already current
+    std::vector<const Base_GraphNode*>& foldedNodes = m_foldedNodes;
+    foldedNodes.clear();
+    for (Base_GraphNode* node : GetDirtyNodesInOrder()) {
+        if (not node->IsCodeDirty()) continue;
+        if (FindInOrder(vertOrder, node) == vertOrder.size() and FindInOrder(fragOrder, node) == fragOrder.size()) continue;
+        node->UpdateCodeCache();
+        if (node->HasConstantOutputs() && node->GetNodeType() == NODE_BUILTIN)
+            foldedNodes.push_back(node);
+    }
+    WriteFoldingReport(m_foldingReport, foldedNodes);
     SetFinalShaderTextByConstructOrders(vertOrder, fragOrder);
+}
 
+void SS_Graph::BuildIntermediatePrograms(const std::vector<Base_GraphNode*>& vertOrder,
+                                         const std::vector<Base_GraphNode*>& fragOrder) {
+    m_areProgramsDeferred = false;
+    Terminal_Node* vn = m_BPManager->GetTerminalVertexNode();
+    // Every intermediate program links the final vertex shader, so a vertex change stales them all
+    if (vn->NeedsIntermediateProgram()) {
+        for (Base_GraphNode* node : vertOrder)
+            node->InvalidateIntermediateProgram();
+        for (Base_GraphNode* node : fragOrder)
+            node->InvalidateIntermediateProgram();
+    }
+
+    if (m_uberPreview) {
+        CompileUberPreviewProgram(vertOrder, fragOrder);
+        // Terminals still display the final material from their own programs
+        for (const std::vector<Base_GraphNode*>* order : { &vertOrder, &fragOrder }) {
+            if (order->back()->GetNodeType() == NODE_TERMINAL and order->back()->NeedsIntermediateProgram())
+                CompileIntermediateCodeForNode(*order, m_intermediateBody, {}, { order->size() - 1 });
+        }
+        return;
+    }
+    // Terminals are part of their orders and so are recompiled here only when dirty
     PropagateIntermediateVertexCodeToNodes(vertOrder);
     PropagateIntermediateFragmentCodeToNodes(fragOrder);
-
-    vn->SetShaderCode(m_currentFragCode, m_currentVertCode);
-    fn->SetShaderCode(m_currentFragCode, m_currentVertCode);
-    vn->CompileIntermediateCode(m_BPManager->MakeMaterial());
-    fn->CompileIntermediateCode(m_BPManager->MakeMaterial());
 }
 
 void SS_Graph::InformOfDelete(int paramID) {
@@ -664,6 +1060,7 @@ void SS_Graph::UpdateParamDataContents(int paramID, GLSL_TYPE type) {
         DisconnectAllPinsByNodeId(nID);
         auto* pn = (Param_Node*) GetNode(nID);
         pn->update_type_from_param(type);
+        pn->PropagateBuildDirty();
     }
     InvalidateShaders();
 }
@@ -673,6 +1070,7 @@ void SS_Graph::UpdateParamDataName(int paramID, const char *name) {
     for (int nID : nodeIDs) {
         auto* pn = (Param_Node*) GetNode(nID);
         pn->SetName(name);
+        pn->PropagateBuildDirty();
     }
     InvalidateShaders();
 }
@@ -5,14 +5,26 @@
 #include "imgui/imgui.h"
 #include "ss_data.hpp"
 #include "ss_node.hpp"
+#include "ss_node_store.hpp"
 #include <unordered_map>
+#include <deque>
+
+// Load an image into a mipmapped texture, 0 if it can't be read
+unsigned int GenerateTextureFrom(const char* img_file);
 
 // MAIN MANAGEMENT CLASS OF THE APPLICATION
 class SS_Graph : public ParamDataGraphHook {
 public:
-    explicit SS_Graph(SS_Boilerplate_Manager* bp);
+    // A headless graph only generates the final shader text, it never touches GL
+    explicit SS_Graph(SS_Boilerplate_Manager* bp, bool headless = false);
     ~SS_Graph() override;
 
+    // Write the graph's nodes, connections, parameters and images, as binary for a .ssgb file and as text otherwise
+    bool SaveGraphFile(const std::string& file) const;
+    // Build a graph from a file written by SaveGraphFile, nullptr if it can't be read.
+        // Images are loaded on the first draw
+    static SS_Graph* LoadGraphFile(const std::string& file, bool headless = false);
+
     // Get node
        // 0 for input change needed, 1 for no, 2 for output changed needed
    // -1 for failed
@@ -46,13 +58,21 @@ Base_GraphNode* GetNode(int id);
     /************************************************
      * *********************CONSTRUCTION **************************/
 
-    // Construct a topological order from the root of a DAG
-    [[nodiscard]] static std::vector<Base_GraphNode*> ConstructTopologicalOrder(Base_GraphNode* root);
+    // Fill order with the root of a DAG and every node feeding it, in topological order, root last
+    void ConstructTopologicalOrder(Base_GraphNode* root, std::vector<Base_GraphNode*>& order);
+    // Fill m_vertOrder and m_fragOrder from the two terminals
+    void ConstructTerminalOrders();
 
     // Main generation function for both intermediate code and final code, from connected graph
     void GenerateShaderTextAndPropagate();
-    // Set the intermediate display code for a node
-    void SetIntermediateCodeForNode(std::string intermedCode, Base_GraphNode* node);
+    // Regenerate the code of the dirty nodes and the final shader text, from both terminals' orders
+    void GenerateShaderText(const std::vector<Base_GraphNode*>& vertOrder, const std::vector<Base_GraphNode*>& fragOrder);
+    // Submit the intermediate programs of the dirty nodes, or the shared preview program
+    void BuildIntermediatePrograms(const std::vector<Base_GraphNode*>& vertOrder,
+                                   const std::vector<Base_GraphNode*>& fragOrder);
+    // Compile the intermediate display program for the last node of the cone, from its cone's statements in the shared body
+    void CompileIntermediateCodeForNode(const std::vector<Base_GraphNode*>& order, const SS_Code_Writer& body,
+                                        const std::vector<size_t>& statementEnds, const std::vector<size_t>& cone);
     // Add a uniform parameter (or sampled image) to the declaration of the shaders, allowing use of a new uniform node
     void AddParameter();
 
@@ -61,34 +81,133 @@ Base_GraphNode* GetNode(int id);
                                              const std::vector<Base_GraphNode *> &fragOrder);
     void PropagateIntermediateVertexCodeToNodes(const std::vector<Base_GraphNode *> &vertOrder);
     void PropagateIntermediateFragmentCodeToNodes(const std::vector<Base_GraphNode *> &fragOrder);
+    // Compile the intermediate programs of the dirty nodes of an order, each from only its own input cone
+    void PropagateIntermediateCodeToNodes(const std::vector<Base_GraphNode *> &order);
+    // Build the single program previewing every non-terminal node, if any of them is build dirty
+    void CompileUberPreviewProgram(const std::vector<Base_GraphNode*>& vertOrder,
+                                   const std::vector<Base_GraphNode*>& fragOrder);
+    // Switch between one program per node preview and a single shared preview program
+    void SetUberPreview(bool enabled);
+    // Swap in the intermediate programs that finished building, once per frame.
+        // Without parallel driver compiles, this is where they are compiled, within a frame time budget
+    void PollPendingPrograms();
+
+    // Nodes with stale code or intermediate programs, whether or not they feed a terminal
+    const SS_Dirty_Set& GetDirtyNodes() const { return m_dirtyNodes; }
+    const SS_Node_Store& GetNodes() const { return m_nodes; }
+    // The dirty nodes, sorted into topological order, valid until the next call
+    const std::vector<Base_GraphNode*>& GetDirtyNodesInOrder();
+
+    // Final shader text of the last build
+    SS_String_View GetVertCode() const { return m_currentVertCode.View(); }
+    SS_String_View GetFragCode() const { return m_currentFragCode.View(); }
+    // Builtins evaluated into literals by the last build, a line each, empty if none were
+    SS_String_View GetFoldingReport() const { return m_foldingReport.View(); }
 
 protected:
-    std::unordered_map<int, std::unique_ptr<Base_GraphNode>> m_nodes;
+    // Without the first build, for graphs restored from a file, which build once they are complete
+    SS_Graph(SS_Boilerplate_Manager* bp, bool headless, bool build);
+    // Take ownership of a node, keeping it in the dirty set while it is dirty
+    void AddNode(int id, Base_GraphNode* node);
+    bool SaveGraphText(const std::string& file) const;
+    bool SaveGraphBinary(const std::string& file) const;
+    static SS_Graph* LoadGraphText(const std::string& file, bool headless);
+    static SS_Graph* LoadGraphBinary(const std::string& file, bool headless);
+    static SS_Graph* MakeLoadedGraph(const std::string& file, const std::string& typeName, bool headless);
+    std::vector<const Base_GraphNode*> GetNodesSortedByID() const;
+    // The edges into the nodes, in the nodes' order and then by input pin
+    std::vector<uint32_t> GetEdgesSortedByInput(const std::vector<const Base_GraphNode*>& nodes) const;
+    // Builtin index, constant gentype, vector op, parameter ID or 1 for the fragment terminal
+    unsigned int GetSavedNodeArg(const Base_GraphNode* node) const;
+    // Add a loaded parameter, nullptr if its type or name is invalid
+    Parameter_Data* RestoreParameter(int id, unsigned int type, unsigned int gentype, const char* name, const char* data);
+    // Build the shader text of a restored graph, its programs are left to the first draw
+    void FinishRestore();
+    // Add a loaded node, keeping its saved ID if free, nullptr if it can't be built
+    Base_GraphNode* RestoreNode(NODE_TYPE type, int id, ImVec2 pos, bool display, unsigned int arg,
+                                const char* name, const float* values);
+    // Load the images of a loaded graph, pointing its samplers at the new textures
+    void LoadPendingImages();
+    // Transform of the canvas this frame, including the screen drag in progress
+    SS_Canvas_View GetView() const;
+    // Mouse drag so far, in canvas units
+    ImVec2 GetCanvasDragDelta() const;
+
+    // Before m_nodes, nodes leave it as they are destroyed
+    SS_Dirty_Set m_dirtyNodes;
+    SS_Node_Store m_nodes;
+    // Every connection between the nodes
+    SS_Edge_Table m_edges{ m_nodes };
+    // Dense indices of the nodes drawn this frame, and of those drawn over them one at a time
+    std::vector<size_t> m_visibleNodes;
+    std::vector<size_t> m_layeredNodes;
+    // Most nodes drawn one at a time, each costs a draw call for its shapes
+    static const size_t k_maxLayeredNodes = 64;
+    // Node shapes and wires of this frame, rendered instanced
+    SS_Canvas_Renderer m_canvasRenderer;
     std::unordered_map<int, std::vector<int>> m_paramIDsToNodeIDs;
 
-    int m_currentNodeID = 0;
+    bool m_headless = false;
+    // Restored graphs submit their programs on the first draw rather than while loading
+    bool m_areProgramsDeferred = false;
+    // Created on the first draw
     unsigned int m_mainFramebuffer{};
 
     bool m_bIsSaving = false;
     bool m_bCreditsUp = false;
     bool m_bControlsUp = false;
     char m_saveBuffer[256]{};
+    char m_graphSaveBuffer[128]{};
 
     int m_paramID = 0;
     ImVec2 m_drawPosOffset = ImVec2(0, 0);
     ImVec2 m_dragPosOffset = ImVec2(0, 0);
+    float m_zoom = 1;
+    // Font size the nodes were last laid out at
+    float m_layoutFontSize = 0;
 
     bool m_bScreenDraggingNow{};
     char m_searchBuffer[256]{};
 
     std::vector<std::pair<unsigned int, std::string> > m_images;
+    // Images of a loaded graph, by the texture they had when saved
+    std::vector<std::pair<unsigned int, std::string> > m_pendingImages;
     char m_imgBuffer[256]{};
 
     std::unique_ptr<SS_Boilerplate_Manager> m_BPManager;
     std::vector<std::unique_ptr<Parameter_Data>> m_paramDatas;
 
-    std::string m_currentFragCode;
-    std::string m_currentVertCode;
+    // Codegen writers, kept across builds so they stop allocating once warmed up
+    SS_Code_Writer m_currentFragCode;
+    SS_Code_Writer m_currentVertCode;
+    SS_Code_Writer m_intermediateBody;
+    SS_Code_Writer m_intermediateFrame;
+    SS_Code_Writer m_foldingReport;
+    ga_shader_source m_intermediateVertSource;
+    ga_shader_source m_intermediateFragSource;
+    // Build scratch, kept across builds like the writers
+    std::vector<Base_GraphNode*> m_vertOrder;
+    std::vector<Base_GraphNode*> m_fragOrder;
+    std::vector<Base_GraphNode*> m_dirtyOrder;
+    // Stamps marking the nodes already collected into an order, by node ID
+    std::vector<uint32_t> m_orderStamps;
+    uint32_t m_orderStamp = 0;
+    std::vector<const Base_GraphNode*> m_foldedNodes;
+    // Structural hashes of the statements with their order index, and the node each statement repeats, by order index
+    std::vector<std::pair<uint64_t, size_t>> m_cseHashes;
+    std::vector<const Base_GraphNode*> m_cseCanonical;
+    std::vector<size_t> m_statementEnds;
+    std::vector<size_t> m_dirtyIndices;
+    std::vector<size_t> m_coneStamps;
+    std::vector<size_t> m_cone;
+    // Nodes with an intermediate program still building, terminals first
+    std::deque<SS_Node_Handle> m_pendingProgramNodes;
+    // Single preview program, selecting the displayed node by ID with a uniform
+    bool m_uberPreview = false;
+    std::unique_ptr<ga_cube_component> m_uberCube;
+    std::unique_ptr<ga_cube_component> m_pendingUberCube;
+    // Nodes the pending preview program displays, built once it links
+    std::vector<SS_Node_Handle> m_pendingUberNodes;
 
     Base_GraphNode* _dragNode = nullptr;
     Base_GraphNode* _selectedNode = nullptr;
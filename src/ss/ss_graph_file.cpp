@@ -0,0 +1,758 @@
+#include "ss_graph.hpp"
+#include "ss_pins.hpp"
+#include "ss_node_factory.hpp"
+#include "ss_boilerplate.hpp"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Text graph files have one record per line, written in the order they are read back:
+ *   shader_sculptor_graph <version>
+ *   type <graph type name>
+ *   image <texture> <path>
+ *   param <id> <type> <gentype> <name> <data as hex>
+ *   node <id> <x> <y> <display up> <kind> <kind data>
+ *   edge <output node id> <output pin> <input node id> <input pin>
+ * Node kinds are builtin, constant, vector, param, boiler and terminal.
+ */
+static const int k_graphFileVersion = 1;
+
+/**
+ * Binary graph files (.ssgb) hold the same records at fixed sizes, read in place from the mapped file:
+ * the header, then the image, parameter, node, pin type, edge and constant value tables, then a
+ * string table of NUL terminated strings. Every record is a multiple of 4 bytes, so each table
+ * stays aligned. Values are in the byte order of the machine that wrote them. Nodes are listed in
+ * topological order, so loading can number them as they come.
+ */
+static const char k_graphBinaryMagic[4] = { 'S', 'S', 'G', 'B' };
+static const uint32_t k_graphBinaryVersion = 1;
+static const uint32_t k_noString = 0xFFFFFFFF;
+
+struct SS_Graph_Binary_Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t typeName;
+    uint32_t imageCount;
+    uint32_t paramCount;
+    uint32_t nodeCount;
+    uint32_t pinCount;
+    uint32_t edgeCount;
+    uint32_t valueCount;
+    uint32_t stringBytes;
+};
+
+struct SS_Graph_Binary_Image {
+    uint32_t texture;
+    uint32_t path;
+};
+
+struct SS_Graph_Binary_Param {
+    int32_t id;
+    uint32_t type;
+    uint32_t gentype;
+    uint32_t name;
+    char data[Parameter_Data::GetDataSize()];
+};
+
+struct SS_Graph_Binary_Node {
+    int32_t id;
+    uint32_t type;
+    float x, y;
+    uint32_t display;
+    // Builtin index, constant gentype, vector op, parameter ID or 1 for the fragment terminal
+    uint32_t arg;
+    // Builtin or boilerplate variable name
+    uint32_t name;
+    // Pin types of the node, inputs then outputs
+    uint32_t firstPin;
+    uint32_t pinCount;
+    // Values of a constant node
+    uint32_t firstValue;
+};
+
+struct SS_Graph_Binary_Edge {
+    int32_t outNode;
+    uint32_t outPin;
+    int32_t inNode;
+    uint32_t inPin;
+};
+
+static_assert(sizeof(SS_Graph_Binary_Header) % 4 == 0 and sizeof(SS_Graph_Binary_Image) % 4 == 0
+              and sizeof(SS_Graph_Binary_Param) % 4 == 0 and sizeof(SS_Graph_Binary_Node) % 4 == 0
+              and sizeof(SS_Graph_Binary_Edge) % 4 == 0, "graph file records must keep the tables aligned");
+
+/**
+ * Read-only view of a whole file, memory mapped where the platform allows it.
+ */
+class SS_Mapped_File {
+public:
+    explicit SS_Mapped_File(const std::string& file) {
+#ifndef _WIN32
+        int fd = open(file.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            struct stat st{};
+            if (fstat(fd, &st) == 0 and st.st_size > 0) {
+                void* mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED) {
+                    m_mapped = (const char*)mapped;
+                    m_size = (size_t)st.st_size;
+                }
+            }
+            close(fd);
+        }
+        if (m_mapped) return;
+#endif
+        std::ifstream in(file, std::ios::binary);
+        m_buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        m_size = m_buffer.size();
+    }
+    ~SS_Mapped_File() {
+#ifndef _WIN32
+        if (m_mapped) munmap((void*)m_mapped, m_size);
+#endif
+    }
+    SS_Mapped_File(const SS_Mapped_File&) = delete;
+    SS_Mapped_File& operator=(const SS_Mapped_File&) = delete;
+
+    const char* Data() const { return m_mapped ? m_mapped : m_buffer.data(); }
+    size_t Size() const { return m_size; }
+
+private:
+    const char* m_mapped = nullptr;
+    size_t m_size = 0;
+    std::vector<char> m_buffer;
+};
+
+// Appends strings to a string table once each, in order of first use
+class SS_String_Table_Writer {
+public:
+    uint32_t Add(SS_Name str) {
+        auto it = m_offsets.find(str);
+        if (it != m_offsets.end()) return it->second;
+        auto offset = (uint32_t)m_table.size();
+        m_table.append(str.c_str(), str.size() + 1);
+        m_offsets.insert(std::make_pair(str, offset));
+        return offset;
+    }
+    uint32_t Add(SS_String_View str) { return Add(SS_Name(str)); }
+    // Padded to keep the file a multiple of 4 bytes
+    const std::string& Finish() {
+        while (m_table.size() % 4 != 0) m_table.push_back('\0');
+        return m_table;
+    }
+
+private:
+    std::string m_table;
+    std::unordered_map<SS_Name, uint32_t> m_offsets;
+};
+
+// Number of floats held by a constant node of the gentype
+static int GetConstantFloatCount(GRAPH_PARAM_GENTYPE gentype) {
+    switch (gentype) {
+        case SS_Scalar: return 1;
+        case SS_Vec2: return 2;
+        case SS_Vec3: return 3;
+        case SS_Vec4:
+        case SS_Mat2: return 4;
+        case SS_Mat3: return 9;
+        case SS_Mat4: return 16;
+        case SS_MAT: break;
+    }
+    return 0;
+}
+
+// Kind of a node in the text format, nullptr for nodes that can't be saved
+static const char* GetNodeKindName(NODE_TYPE type) {
+    switch (type) {
+        case NODE_BUILTIN: return "builtin";
+        case NODE_CONSTANT: return "constant";
+        case NODE_VECTOR_OP: return "vector";
+        case NODE_PARAM: return "param";
+        case NODE_BOILER_VAR: return "boiler";
+        case NODE_TERMINAL: return "terminal";
+        default: return nullptr;
+    }
+}
+
+static bool EndsWith(const std::string& str, const std::string& end) {
+    return str.size() >= end.size() and str.compare(str.size() - end.size(), end.size(), end) == 0;
+}
+
+// Node a record refers to by its saved ID, nullptr if that node wasn't loaded
+static Base_GraphNode* FindLoadedNode(const std::unordered_map<int, Base_GraphNode*>& loadedNodes, int fileID) {
+    auto it = loadedNodes.find(fileID);
+    return it == loadedNodes.end() ? nullptr : it->second;
+}
+
+bool SS_Graph::SaveGraphFile(const std::string& file) const {
+    return EndsWith(file, ".ssgb") ? SaveGraphBinary(file) : SaveGraphText(file);
+}
+
+SS_Graph* SS_Graph::LoadGraphFile(const std::string& file, bool headless) {
+    std::ifstream in(file, std::ios::binary);
+    if (not in.good()) {
+        std::cerr << "ERROR: Couldn't open graph file " << file << std::endl;
+        return nullptr;
+    }
+    char magic[sizeof(k_graphBinaryMagic)] = {};
+    in.read(magic, sizeof(magic));
+    in.close();
+    if (memcmp(magic, k_graphBinaryMagic, sizeof(magic)) == 0)
+        return LoadGraphBinary(file, headless);
+    return LoadGraphText(file, headless);
+}
+
+std::vector<const Base_GraphNode*> SS_Graph::GetNodesSortedByID() const {
+    std::vector<const Base_GraphNode*> nodes;
+    nodes.reserve(m_nodes.Size());
+    for (const auto& node : m_nodes)
+        nodes.push_back(node.get());
+    std::sort(nodes.begin(), nodes.end(),
+              [](const Base_GraphNode* a, const Base_GraphNode* b) { return a->GetID() < b->GetID(); });
+    return nodes;
+}
+
+std::vector<uint32_t> SS_Graph::GetEdgesSortedByInput(const std::vector<const Base_GraphNode*>& nodes) const {
+    std::vector<int> nodeRanks((size_t)m_nodes.GetIDCapacity(), -1);
+    for (size_t n = 0; n < nodes.size(); ++n)
+        nodeRanks[nodes[n]->GetID()] = (int)n;
+    std::vector<uint32_t> sorted;
+    sorted.reserve(m_edges.Size());
+    m_edges.ForEachEdge([&](uint32_t e) {
+        if (nodeRanks[m_edges.GetDestNode(e)] >= 0) sorted.push_back(e);
+    });
+    std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+        int rankA = nodeRanks[m_edges.GetDestNode(a)], rankB = nodeRanks[m_edges.GetDestNode(b)];
+        return rankA != rankB ? rankA < rankB : m_edges.GetDestPin(a) < m_edges.GetDestPin(b);
+    });
+    return sorted;
+}
+
+unsigned int SS_Graph::GetSavedNodeArg(const Base_GraphNode* node) const {
+    switch (node->GetNodeType()) {
+        case NODE_BUILTIN: return (unsigned int)((const Builtin_GraphNode*)node)->GetDefinitionIndex();
+        case NODE_CONSTANT: return (unsigned int)((const Constant_Node*)node)->_data_gen;
+        case NODE_VECTOR_OP: return (unsigned int)((const Vector_Op_Node*)node)->_vec_op;
+        case NODE_PARAM: return (unsigned int)((const Param_Node*)node)->_paramID;
+        // By identity, a terminal's frag_node flag follows its first pin rather than its stage
+        case NODE_TERMINAL: return node == m_BPManager->GetTerminalFragNode() ? 1 : 0;
+        default: return 0;
+    }
+}
+
+bool SS_Graph::SaveGraphText(const std::string& file) const {
+    std::ofstream out(file);
+    if (not out.good()) return false;
+    out.precision(9);
+
+    out << "shader_sculptor_graph " << k_graphFileVersion << '\n';
+    out << "type " << m_BPManager->GetGraphTypeName() << '\n';
+    for (const auto* images : { &m_images, &m_pendingImages }) {
+        for (const auto& image : *images)
+            out << "image " << image.first << ' ' << image.second << '\n';
+    }
+
+    for (const auto& p_data : m_paramDatas) {
+        out << "param " << p_data->GetID() << ' ' << (int)p_data->GetParamType() << ' '
+            << (int)p_data->GetParamGenType() << ' ' << p_data->GetName() << ' ';
+        const char* hex = "0123456789abcdef";
+        for (unsigned i = 0; i < Parameter_Data::GetDataSize(); ++i) {
+            auto byte = (unsigned char)p_data->GetData()[i];
+            out << hex[byte >> 4] << hex[byte & 15];
+        }
+        out << '\n';
+    }
+
+    // Sorted, so saving the same graph twice gives the same file
+    std::vector<const Base_GraphNode*> nodes = GetNodesSortedByID();
+    for (const Base_GraphNode* node : nodes) {
+        const char* kind = GetNodeKindName(node->GetNodeType());
+        if (not kind) {
+            std::cerr << "WARNING: Node " << node->GetName() << ", id=" << node->GetID() << " can't be saved." << std::endl;
+            continue;
+        }
+        out << "node " << node->GetID() << ' ' << node->GetDrawOldPos().x << ' ' << node->GetDrawOldPos().y << ' '
+            << (node->GetHasDisplayUp() ? 1 : 0) << ' ' << kind << ' ';
+        unsigned int arg = GetSavedNodeArg(node);
+        switch (node->GetNodeType()) {
+            case NODE_BUILTIN: out << (int)arg << ' ' << node->GetName(); break;
+            case NODE_CONSTANT: {
+                auto* cn = (const Constant_Node*)node;
+                out << arg;
+                for (int i = 0; i < GetConstantFloatCount(cn->_data_gen); ++i)
+                    out << ' ' << ((const float*)cn->_data)[i];
+                break;
+            }
+            case NODE_VECTOR_OP: out << arg; break;
+            case NODE_PARAM: out << (int)arg; break;
+            case NODE_BOILER_VAR: out << node->GetName(); break;
+            case NODE_TERMINAL: out << (arg ? "frag" : "vert"); break;
+            default: break;
+        }
+        out << '\n';
+    }
+
+    for (uint32_t e : GetEdgesSortedByInput(nodes)) {
+        out << "edge " << m_edges.GetSourceNode(e) << ' ' << m_edges.GetSourcePin(e) << ' '
+            << m_edges.GetDestNode(e) << ' ' << m_edges.GetDestPin(e) << '\n';
+    }
+    return out.good();
+}
+
+template <typename T>
+static void WriteTable(std::ofstream& out, const std::vector<T>& table) {
+    if (not table.empty()) out.write((const char*)table.data(), (std::streamsize)(table.size() * sizeof(T)));
+}
+
+bool SS_Graph::SaveGraphBinary(const std::string& file) const {
+    SS_String_Table_Writer strings;
+    SS_Graph_Binary_Header header{};
+    memcpy(header.magic, k_graphBinaryMagic, sizeof(header.magic));
+    header.version = k_graphBinaryVersion;
+    header.typeName = strings.Add(m_BPManager->GetGraphTypeName());
+
+    std::vector<SS_Graph_Binary_Image> images;
+    for (const auto* imageList : { &m_images, &m_pendingImages }) {
+        for (const auto& image : *imageList)
+            images.push_back(SS_Graph_Binary_Image{ image.first, strings.Add(image.second) });
+    }
+
+    std::vector<SS_Graph_Binary_Param> params(m_paramDatas.size());
+    for (size_t p = 0; p < m_paramDatas.size(); ++p) {
+        const Parameter_Data& p_data = *m_paramDatas[p];
+        params[p].id = p_data.GetID();
+        params[p].type = p_data.GetParamType();
+        params[p].gentype = p_data.GetParamGenType();
+        params[p].name = strings.Add(p_data.GetName());
+        memcpy(params[p].data, p_data.GetData(), sizeof(params[p].data));
+    }
+
+    // In topological order, which loading keeps
+    std::vector<const Base_GraphNode*> nodes = GetNodesSortedByID();
+    std::sort(nodes.begin(), nodes.end(), [](const Base_GraphNode* a, const Base_GraphNode* b) {
+        return a->GetTopologicalIndex() < b->GetTopologicalIndex();
+    });
+    std::vector<SS_Graph_Binary_Node> nodeRecords;
+    std::vector<uint32_t> pins;
+    std::vector<SS_Graph_Binary_Edge> edges;
+    std::vector<float> values;
+    std::vector<const Base_GraphNode*> savedNodes;
+    nodeRecords.reserve(nodes.size());
+    for (const Base_GraphNode* node : nodes) {
+        if (not GetNodeKindName(node->GetNodeType())) {
+            std::cerr << "WARNING: Node " << node->GetName() << ", id=" << node->GetID() << " can't be saved." << std::endl;
+            continue;
+        }
+        savedNodes.push_back(node);
+        SS_Graph_Binary_Node record{};
+        record.id = node->GetID();
+        record.type = node->GetNodeType();
+        record.x = node->GetDrawOldPos().x;
+        record.y = node->GetDrawOldPos().y;
+        record.display = node->GetHasDisplayUp() ? 1 : 0;
+        record.arg = GetSavedNodeArg(node);
+        record.name = node->GetNodeType() == NODE_BUILTIN or node->GetNodeType() == NODE_BOILER_VAR
+                      ? strings.Add(node->GetName()) : k_noString;
+        record.firstPin = (uint32_t)pins.size();
+        for (int i = 0; i < node->GetInputPinCount(); ++i)
+            pins.push_back(node->GetInputPin(i).type.type_flags);
+        for (int o = 0; o < node->GetOutputPinCount(); ++o)
+            pins.push_back(node->GetOutputPin(o).type.type_flags);
+        record.pinCount = (uint32_t)pins.size() - record.firstPin;
+        record.firstValue = (uint32_t)values.size();
+        if (node->GetNodeType() == NODE_CONSTANT) {
+            auto* cn = (const Constant_Node*)node;
+            const float* data = (const float*)cn->_data;
+            values.insert(values.end(), data, data + GetConstantFloatCount(cn->_data_gen));
+        }
+        nodeRecords.push_back(record);
+    }
+    for (uint32_t e : GetEdgesSortedByInput(savedNodes)) {
+        edges.push_back(SS_Graph_Binary_Edge{ m_edges.GetSourceNode(e), (uint32_t)m_edges.GetSourcePin(e),
+                                              m_edges.GetDestNode(e), (uint32_t)m_edges.GetDestPin(e) });
+    }
+
+    const std::string& stringTable = strings.Finish();
+    header.imageCount = (uint32_t)images.size();
+    header.paramCount = (uint32_t)params.size();
+    header.nodeCount = (uint32_t)nodeRecords.size();
+    header.pinCount = (uint32_t)pins.size();
+    header.edgeCount = (uint32_t)edges.size();
+    header.valueCount = (uint32_t)values.size();
+    header.stringBytes = (uint32_t)stringTable.size();
+
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (not out.good()) return false;
+    out.write((const char*)&header, sizeof(header));
+    WriteTable(out, images);
+    WriteTable(out, params);
+    WriteTable(out, nodeRecords);
+    WriteTable(out, pins);
+    WriteTable(out, edges);
+    WriteTable(out, values);
+    out.write(stringTable.data(), (std::streamsize)stringTable.size());
+    return out.good();
+}
+
+SS_Graph* SS_Graph::MakeLoadedGraph(const std::string& file, const std::string& typeName, bool headless) {
+    SS_Boilerplate_Manager* bp = SS_Boilerplate_Manager::MakeFromGraphTypeName(typeName);
+    if (not bp) {
+        std::cerr << "ERROR: " << file << " has unknown graph type " << typeName << std::endl;
+        return nullptr;
+    }
+    return new SS_Graph(bp, headless, false);
+}
+
+Parameter_Data* SS_Graph::RestoreParameter(int id, unsigned int type, unsigned int gentype, const char* name, const char* data) {
+    if (type > SS_TextureCube or gentype > SS_Mat4 or strlen(name) >= 64) return nullptr;
+    auto* p_data = new Parameter_Data((GRAPH_PARAM_TYPE)type, (GRAPH_PARAM_GENTYPE)gentype, 1, id, this);
+    // Samplers keep the saved texture until LoadPendingImages
+    p_data->SetData(data);
+    p_data->UpdateName(this, name);
+    m_paramDatas.emplace_back(p_data);
+    m_paramID = std::max(m_paramID, id);
+    return p_data;
+}
+
+void SS_Graph::FinishRestore() {
+    ConstructTerminalOrders();
+    GenerateShaderText(m_vertOrder, m_fragOrder);
+    m_areProgramsDeferred = not m_headless;
+}
+
+Base_GraphNode* SS_Graph::RestoreNode(NODE_TYPE type, int id, ImVec2 pos, bool display, unsigned int arg,
+                                      const char* name, const float* values) {
+    Base_GraphNode* node = nullptr;
+    if (type == NODE_TERMINAL) {
+        node = arg ? (Base_GraphNode*)m_BPManager->GetTerminalFragNode() : (Base_GraphNode*)m_BPManager->GetTerminalVertexNode();
+        node->SetDrawOldPos(pos);
+        if (display and not node->GetHasDisplayUp()) node->ToggleDisplay();
+        return node;
+    }
+
+    // Saved IDs are kept where they are free, the rest take free IDs. Connections are by saved ID, so they hold either way
+    int nodeID = m_nodes.IsFreeID(id) ? id : m_nodes.NextFreeID();
+    switch (type) {
+        case NODE_BUILTIN: {
+            const Builtin_Node_Data* data = SS_Node_Factory::GetBuiltinNodeData((int)arg);
+            if (data and name and data->_name.View() == SS_String_View(name))
+                node = SS_Node_Factory::BuildBuiltinNode(*data, nodeID, pos);
+            else
+                std::cerr << "ERROR: Builtin " << (name ? name : "") << " is not in the builtin function file" << std::endl;
+            break;
+        }
+        case NODE_CONSTANT: {
+            const Constant_Node_Data* data = SS_Node_Factory::GetConstantNodeData(arg);
+            if (not data) break;
+            auto* cn = SS_Node_Factory::BuildConstantNode(*data, nodeID, pos);
+            memcpy(cn->_data, values, GetConstantFloatCount(data->m_gentype) * sizeof(float));
+            node = cn;
+            break;
+        }
+        case NODE_VECTOR_OP: {
+            const Vector_Op_Node_Data* data = SS_Node_Factory::GetVectorOpNodeData(arg);
+            if (data) node = SS_Node_Factory::BuildVecOpNode(*data, nodeID, pos);
+            break;
+        }
+        case NODE_PARAM:
+            for (const auto& p_data : m_paramDatas) {
+                if (p_data->GetID() != (int)arg) continue;
+                node = SS_Node_Factory::BuildParamNode(p_data.get(), nodeID, pos);
+                m_paramIDsToNodeIDs[p_data->GetID()].push_back(nodeID);
+                break;
+            }
+            break;
+        case NODE_BOILER_VAR:
+            for (const Boilerplate_Var_Data& data : m_BPManager->GetUsableVariables()) {
+                if (not name or data._name != name) continue;
+                node = SS_Node_Factory::BuildBoilerplateVarNode(data, m_BPManager.get(), nodeID, pos);
+                break;
+            }
+            break;
+        default:
+            break;
+    }
+    if (not node) return nullptr;
+    AddNode(nodeID, node);
+    if (display and not node->GetHasDisplayUp()) node->ToggleDisplay();
+    return node;
+}
+
+void SS_Graph::LoadPendingImages() {
+    if (m_pendingImages.empty()) return;
+    std::unordered_map<unsigned int, unsigned int> loadedTextures;
+    for (const auto& image : m_pendingImages) {
+        unsigned int texture = GenerateTextureFrom(image.second.c_str());
+        if (texture > 0) m_images.emplace_back(texture, image.second);
+        loadedTextures[image.first] = texture;
+    }
+    m_pendingImages.clear();
+
+    // Samplers hold the texture of an image, which is new in this session
+    for (const auto& p_data : m_paramDatas) {
+        if (p_data->GetParamType() != SS_Texture2D) continue;
+        char data[Parameter_Data::GetDataSize()];
+        memcpy(data, p_data->GetData(), sizeof(data));
+        unsigned int texture;
+        memcpy(&texture, data, sizeof(texture));
+        texture = loadedTextures.count(texture) ? loadedTextures[texture] : 0;
+        memcpy(data, &texture, sizeof(texture));
+        p_data->SetData(data);
+    }
+}
+
+SS_Graph* SS_Graph::LoadGraphText(const std::string& file, bool headless) {
+    std::ifstream in(file);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line); )
+        lines.push_back(line);
+
+    std::string token;
+    int version = 0;
+    std::string typeName;
+    if (lines.size() < 2
+        or not (std::istringstream(lines[0]) >> token >> version) or token != "shader_sculptor_graph"
+        or not (std::istringstream(lines[1]) >> token >> typeName) or token != "type") {
+        std::cerr << "ERROR: " << file << " is not a graph file" << std::endl;
+        return nullptr;
+    }
+    if (version != k_graphFileVersion) {
+        std::cerr << "ERROR: " << file << " has graph file version " << version << ", expected " << k_graphFileVersion << std::endl;
+        return nullptr;
+    }
+    std::unique_ptr<SS_Graph> graph(MakeLoadedGraph(file, typeName, headless));
+    if (not graph) return nullptr;
+
+    std::unordered_map<int, Base_GraphNode*> loadedNodes;
+    for (size_t l = 2; l < lines.size(); ++l) {
+        std::istringstream iss(lines[l]);
+        if (not (iss >> token)) continue;
+        bool ok = true;
+
+        if (token == "image") {
+            unsigned int texture = 0;
+            std::string path;
+            ok = bool(iss >> texture) and bool(std::getline(iss >> std::ws, path));
+            if (ok) graph->m_pendingImages.emplace_back(texture, path);
+        }
+        else if (token == "param") {
+            int id = 0;
+            unsigned int type = 0, gentype = 0;
+            std::string name, hex;
+            ok = bool(iss >> id >> type >> gentype >> name >> hex)
+                 and hex.size() == 2 * Parameter_Data::GetDataSize()
+                 and hex.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos;
+            if (ok) {
+                char data[Parameter_Data::GetDataSize()];
+                for (unsigned i = 0; i < Parameter_Data::GetDataSize(); ++i)
+                    data[i] = (char)std::stoi(hex.substr(2 * i, 2), nullptr, 16);
+                ok = graph->RestoreParameter(id, type, gentype, name.c_str(), data) != nullptr;
+            }
+        }
+        else if (token == "node") {
+            int id = 0, display = 0;
+            ImVec2 pos;
+            std::string kind;
+            ok = bool(iss >> id >> pos.x >> pos.y >> display >> kind);
+            NODE_TYPE type = NODE_DEFAULT;
+            for (NODE_TYPE t : { NODE_BUILTIN, NODE_CONSTANT, NODE_VECTOR_OP, NODE_PARAM, NODE_BOILER_VAR, NODE_TERMINAL }) {
+                if (kind == GetNodeKindName(t)) type = t;
+            }
+
+            int arg = 0;
+            std::string name;
+            float values[16] = {};
+            switch (type) {
+                case NODE_BUILTIN: ok = ok and bool(iss >> arg >> name); break;
+                case NODE_CONSTANT:
+                    ok = ok and bool(iss >> arg);
+                    for (int i = 0; ok and i < GetConstantFloatCount((GRAPH_PARAM_GENTYPE)arg); ++i)
+                        ok = bool(iss >> values[i]);
+                    break;
+                case NODE_VECTOR_OP:
+                case NODE_PARAM: ok = ok and bool(iss >> arg); break;
+                case NODE_BOILER_VAR: ok = ok and bool(std::getline(iss >> std::ws, name)); break;
+                case NODE_TERMINAL:
+                    ok = ok and bool(iss >> name);
+                    arg = name == "frag" ? 1 : 0;
+                    break;
+                default: ok = false; break;
+            }
+            Base_GraphNode* node = ok ? graph->RestoreNode(type, id, pos, display != 0, (unsigned int)arg, name.c_str(), values)
+                                      : nullptr;
+            ok = node != nullptr;
+            if (ok) loadedNodes[id] = node;
+        }
+        else if (token == "edge") {
+            int outID = 0, outPin = -1, inID = 0, inPin = -1;
+            ok = bool(iss >> outID >> outPin >> inID >> inPin);
+            Base_GraphNode* outNode = FindLoadedNode(loadedNodes, outID);
+            Base_GraphNode* inNode = FindLoadedNode(loadedNodes, inID);
+            ok = ok and outNode and inNode
+                 and outPin >= 0 and outPin < outNode->GetOutputPinCount()
+                 and inPin >= 0 and inPin < inNode->GetInputPinCount()
+                 and PinOps::ConnectPins(&inNode->GetInputPin(inPin), &outNode->GetOutputPin(outPin));
+        }
+        else {
+            ok = false;
+        }
+
+        if (not ok) {
+            std::cerr << "WARNING: " << file << ":" << l + 1 << ": skipped \"" << lines[l] << "\"" << std::endl;
+        }
+    }
+
+    graph->FinishRestore();
+    return graph.release();
+}
+
+// Whether every connection goes from a lower topological index to a higher one, which rules out cycles
+static bool IsInTopologicalOrder(const SS_Edge_Table& edges) {
+    bool inOrder = true;
+    edges.ForEachEdge([&](uint32_t e) {
+        inOrder &= edges.GetOutputPin(e).owner->GetTopologicalIndex() < edges.GetInputPin(e).owner->GetTopologicalIndex();
+    });
+    return inOrder;
+}
+
+// Number the nodes in topological order, false if the connections between them have a cycle
+static bool AssignTopologicalOrder(const SS_Node_Store& nodes, SS_Edge_Table& edges) {
+    // By node ID
+    std::vector<int> inDegrees((size_t)nodes.GetIDCapacity(), 0);
+    edges.ForEachEdge([&](uint32_t e) { ++inDegrees[edges.GetDestNode(e)]; });
+    std::vector<Base_GraphNode*> sources;
+    for (const auto& node : nodes) {
+        if (inDegrees[node->GetID()] == 0) sources.push_back(node.get());
+    }
+    // By ID, so a file always loads in the same order
+    std::sort(sources.begin(), sources.end(), [](const Base_GraphNode* a, const Base_GraphNode* b) { return a->GetID() < b->GetID(); });
+    std::queue<Base_GraphNode*> ready;
+    for (Base_GraphNode* node : sources)
+        ready.push(node);
+    size_t visited = 0;
+    while (not ready.empty()) {
+        Base_GraphNode* node = ready.front();
+        ready.pop();
+        node->SetTopologicalIndex(Base_GraphNode::NextTopologicalIndex());
+        ++visited;
+        edges.ForEachOutEdge(node->GetID(), [&](uint32_t e) {
+            if (--inDegrees[edges.GetDestNode(e)] == 0) ready.push(edges.GetInputPin(e).owner);
+        });
+    }
+    return visited == nodes.Size();
+}
+
+SS_Graph* SS_Graph::LoadGraphBinary(const std::string& file, bool headless) {
+    SS_Mapped_File mapped(file);
+    const char* data = mapped.Data();
+    size_t size = mapped.Size();
+
+    SS_Graph_Binary_Header header{};
+    if (size < sizeof(header)) {
+        std::cerr << "ERROR: " << file << " is not a graph file" << std::endl;
+        return nullptr;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.version != k_graphBinaryVersion) {
+        std::cerr << "ERROR: " << file << " has graph file version " << header.version << ", expected " << k_graphBinaryVersion << std::endl;
+        return nullptr;
+    }
+
+    // Table locations, in 64 bits so a corrupt count can't wrap around the size check
+    uint64_t offset = sizeof(header);
+    uint64_t imagesAt = offset; offset += uint64_t(header.imageCount) * sizeof(SS_Graph_Binary_Image);
+    uint64_t paramsAt = offset; offset += uint64_t(header.paramCount) * sizeof(SS_Graph_Binary_Param);
+    uint64_t nodesAt = offset; offset += uint64_t(header.nodeCount) * sizeof(SS_Graph_Binary_Node);
+    uint64_t pinsAt = offset; offset += uint64_t(header.pinCount) * sizeof(uint32_t);
+    uint64_t edgesAt = offset; offset += uint64_t(header.edgeCount) * sizeof(SS_Graph_Binary_Edge);
+    uint64_t valuesAt = offset; offset += uint64_t(header.valueCount) * sizeof(float);
+    uint64_t stringsAt = offset; offset += header.stringBytes;
+    if (offset != size or header.stringBytes == 0 or data[size - 1] != '\0') {
+        std::cerr << "ERROR: " << file << " is truncated or corrupt" << std::endl;
+        return nullptr;
+    }
+    const auto* images = (const SS_Graph_Binary_Image*)(data + imagesAt);
+    const auto* params = (const SS_Graph_Binary_Param*)(data + paramsAt);
+    const auto* nodes = (const SS_Graph_Binary_Node*)(data + nodesAt);
+    const auto* pins = (const uint32_t*)(data + pinsAt);
+    const auto* edges = (const SS_Graph_Binary_Edge*)(data + edgesAt);
+    const auto* values = (const float*)(data + valuesAt);
+    const char* strings = data + stringsAt;
+    // The table ends with a NUL, so any offset inside it is a terminated string
+    auto getString = [&](uint32_t at) -> const char* { return at < header.stringBytes ? strings + at : nullptr; };
+
+    const char* typeName = getString(header.typeName);
+    std::unique_ptr<SS_Graph> graph(MakeLoadedGraph(file, typeName ? typeName : "", headless));
+    if (not graph) return nullptr;
+
+    for (uint32_t i = 0; i < header.imageCount; ++i) {
+        const char* path = getString(images[i].path);
+        if (path) graph->m_pendingImages.emplace_back(images[i].texture, path);
+    }
+    for (uint32_t p = 0; p < header.paramCount; ++p) {
+        const char* name = getString(params[p].name);
+        if (not name or not graph->RestoreParameter(params[p].id, params[p].type, params[p].gentype, name, params[p].data))
+            std::cerr << "WARNING: " << file << ": skipped parameter " << params[p].id << std::endl;
+    }
+
+    graph->m_nodes.Reserve(header.nodeCount);
+    std::unordered_map<int, Base_GraphNode*> loadedNodes;
+    loadedNodes.reserve(header.nodeCount);
+    for (uint32_t n = 0; n < header.nodeCount; ++n) {
+        const SS_Graph_Binary_Node& record = nodes[n];
+        int valueCount = record.type == NODE_CONSTANT and record.arg <= SS_Mat4
+                         ? GetConstantFloatCount((GRAPH_PARAM_GENTYPE)record.arg) : 0;
+        bool inRange = uint64_t(record.firstPin) + record.pinCount <= header.pinCount
+                       and uint64_t(record.firstValue) + valueCount <= header.valueCount;
+        Base_GraphNode* node = inRange ? graph->RestoreNode((NODE_TYPE)record.type, record.id, ImVec2(record.x, record.y),
+                                                            record.display != 0, record.arg, getString(record.name),
+                                                            values + record.firstValue) : nullptr;
+        if (not node or (int)record.pinCount != node->GetInputPinCount() + node->GetOutputPinCount()) {
+            std::cerr << "WARNING: " << file << ": skipped node " << record.id << std::endl;
+            continue;
+        }
+        // Saved after propagation through the connections, so joining the gentype classes changes none of them
+        node->SetTopologicalIndex(Base_GraphNode::NextTopologicalIndex());
+        const uint32_t* pinTypes = pins + record.firstPin;
+        for (int i = 0; i < node->GetInputPinCount(); ++i)
+            node->GetInputPin(i).type.type_flags = *pinTypes++;
+        for (int o = 0; o < node->GetOutputPinCount(); ++o)
+            node->GetOutputPin(o).type.type_flags = *pinTypes++;
+        loadedNodes[record.id] = node;
+    }
+
+    // Linked directly rather than through PinOps::ConnectPins, the nodes were numbered in file order and are checked once below
+    for (uint32_t e = 0; e < header.edgeCount; ++e) {
+        const SS_Graph_Binary_Edge& edge = edges[e];
+        Base_GraphNode* outNode = FindLoadedNode(loadedNodes, edge.outNode);
+        Base_GraphNode* inNode = FindLoadedNode(loadedNodes, edge.inNode);
+        if (not outNode or not inNode or edge.outPin >= (uint32_t)outNode->GetOutputPinCount()
+            or edge.inPin >= (uint32_t)inNode->GetInputPinCount() or inNode->GetInputPin((int)edge.inPin).input) {
+            std::cerr << "WARNING: " << file << ": skipped edge " << edge.outNode << ":" << edge.outPin
+                      << " -> " << edge.inNode << ":" << edge.inPin << std::endl;
+            continue;
+        }
+        Base_InputPin& in_pin = inNode->GetInputPin((int)edge.inPin);
+        Base_OutputPin& out_pin = outNode->GetOutputPin((int)edge.outPin);
+        graph->m_edges.Link(out_pin, in_pin);
+        // A union of the pins' gentype classes, their lengths were saved already resolved
+        PinOps::JoinGentypes(&in_pin, &out_pin);
+    }
+    if (not IsInTopologicalOrder(graph->m_edges) and not AssignTopologicalOrder(graph->m_nodes, graph->m_edges)) {
+        std::cerr << "ERROR: " << file << " connects its nodes in a cycle" << std::endl;
+        return nullptr;
+    }
+
+    graph->FinishRestore();
+    return graph.release();
+}
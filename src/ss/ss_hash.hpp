@@ -0,0 +1,33 @@
+#ifndef SHADER_SCUPLTOR_SS_HASH_HPP
+#define SHADER_SCUPLTOR_SS_HASH_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/**
+ * 64-bit FNV-1a hashing, folded incrementally: pass the previous result back in as the seed.
+ */
+namespace SS_Hash {
+    const uint64_t Seed = 14695981039346656037ull;
+    const uint64_t Prime = 1099511628211ull;
+
+    inline uint64_t Bytes(uint64_t hash, const void* data, size_t size) {
+        const auto* bytes = (const unsigned char*)data;
+        for (size_t b = 0; b < size; ++b) {
+            hash ^= bytes[b];
+            hash *= Prime;
+        }
+        return hash;
+    }
+    inline uint64_t String(uint64_t hash, const std::string& str) {
+        return Bytes(hash, str.data(), str.size());
+    }
+    // ONLY for padding-free values such as integers and floats
+    template <typename T>
+    inline uint64_t Value(uint64_t hash, const T& value) {
+        return Bytes(hash, &value, sizeof(T));
+    }
+}
+
+#endif //SHADER_SCUPLTOR_SS_HASH_HPP
@@ -0,0 +1,132 @@
+#include "ss_name.hpp"
+#include "ss_hash.hpp"
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace {
+    struct Interned {
+        const char* data;
+        size_t size;
+        uint64_t hash;
+    };
+
+    /**
+     * Open addressing table of IDs, probed linearly, over text packed into chunks which are never freed.
+     * The empty string is never looked up, so its ID 0 marks the empty slots.
+     */
+    class Name_Table {
+    public:
+        Name_Table() {
+            m_names.push_back(Interned{ "", 0, SS_Hash::Seed });
+            m_slots.assign(256, 0);
+        }
+
+        uint32_t Intern(SS_String_View str) {
+            if (str.empty()) return 0;
+            uint64_t hash = SS_Hash::Bytes(SS_Hash::Seed, str.data, str.size);
+            size_t slot = FindSlot(str, hash);
+            if (m_slots[slot] != 0) return m_slots[slot];
+
+            // Kept under half full
+            if ((m_names.size() + 1) * 2 > m_slots.size()) {
+                Grow();
+                slot = FindSlot(str, hash);
+            }
+            auto id = (uint32_t)m_names.size();
+            m_names.push_back(Interned{ Store(str), str.size, hash });
+            m_slots[slot] = id;
+            return id;
+        }
+
+        const Interned& Get(uint32_t id) const {
+            assert(id < m_names.size());
+            return m_names[id];
+        }
+        size_t Count() const { return m_names.size(); }
+
+    private:
+        // Chunks hold many short names, longer ones get a chunk of their own
+        static const size_t k_chunkSize = 16 * 1024;
+
+        // Slot of the string, or the empty slot where it would go
+        size_t FindSlot(SS_String_View str, uint64_t hash) const {
+            size_t mask = m_slots.size() - 1;
+            for (size_t slot = (size_t)hash & mask;; slot = (slot + 1) & mask) {
+                uint32_t id = m_slots[slot];
+                if (id == 0) return slot;
+                const Interned& name = m_names[id];
+                if (name.hash == hash && SS_String_View(name.data, name.size) == str) return slot;
+            }
+        }
+
+        void Grow() {
+            m_slots.assign(m_slots.size() * 2, 0);
+            size_t mask = m_slots.size() - 1;
+            for (uint32_t id = 1; id < (uint32_t)m_names.size(); ++id) {
+                size_t slot = (size_t)m_names[id].hash & mask;
+                while (m_slots[slot] != 0) slot = (slot + 1) & mask;
+                m_slots[slot] = id;
+            }
+        }
+
+        const char* Store(SS_String_View str) {
+            size_t needed = str.size + 1;
+            if (needed > k_chunkSize / 4) {
+                m_chunks.emplace_back(new char[needed]);
+                return Copy(m_chunks.back().get(), str);
+            }
+            if (needed > m_chunkLeft) {
+                m_chunks.emplace_back(new char[k_chunkSize]);
+                m_chunkCursor = m_chunks.back().get();
+                m_chunkLeft = k_chunkSize;
+            }
+            const char* stored = Copy(m_chunkCursor, str);
+            m_chunkCursor += needed;
+            m_chunkLeft -= needed;
+            return stored;
+        }
+
+        static const char* Copy(char* dest, SS_String_View str) {
+            std::memcpy(dest, str.data, str.size);
+            dest[str.size] = '\0';
+            return dest;
+        }
+
+        // By ID
+        std::vector<Interned> m_names;
+        std::vector<uint32_t> m_slots;
+        std::vector<std::unique_ptr<char[]>> m_chunks;
+        char* m_chunkCursor = nullptr;
+        size_t m_chunkLeft = 0;
+    };
+
+    // Made on first use, so names can be interned while other statics are initialized
+    Name_Table& GetTable() {
+        static Name_Table table;
+        return table;
+    }
+}
+
+SS_Name::SS_Name(SS_String_View str) : m_id(GetTable().Intern(str)) {}
+
+SS_String_View SS_Name::View() const {
+    const Interned& name = GetTable().Get(m_id);
+    return SS_String_View(name.data, name.size);
+}
+
+const char* SS_Name::c_str() const {
+    return GetTable().Get(m_id).data;
+}
+
+size_t SS_Name::size() const {
+    return GetTable().Get(m_id).size;
+}
+
+uint64_t SS_Name::Hash() const {
+    return GetTable().Get(m_id).hash;
+}
+
+size_t SS_Name::GetCount() {
+    return GetTable().Count();
+}
@@ -0,0 +1,55 @@
+#ifndef SS_NAME
+#define SS_NAME
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "ss_code_writer.hpp"
+
+/**
+ * Interned string, an ID into a table shared by the whole program.
+ * Equal strings have equal IDs, so names compare and hash as integers, and their text is stored once, never moves
+ * and is never freed. The length and hash of the text are kept alongside it. The default name is the empty string.
+ * Used for the names of nodes, pins and builtins and for GLSL type names.
+ * WARNING: interning is not thread safe, names are only made on the main thread.
+ */
+class SS_Name {
+public:
+    SS_Name() = default;
+    // Find or add the string, hashing it once
+    explicit SS_Name(SS_String_View str);
+
+    SS_String_View View() const;
+    operator SS_String_View() const { return View(); }
+    // Null terminated
+    const char* c_str() const;
+    size_t size() const;
+    bool empty() const { return m_id == 0; }
+    std::string str() const { return View().str(); }
+    // SS_Hash of the text, the same in every run, unlike the ID
+    uint64_t Hash() const;
+    uint32_t GetID() const { return m_id; }
+
+    bool operator==(const SS_Name& other) const { return m_id == other.m_id; }
+    bool operator!=(const SS_Name& other) const { return m_id != other.m_id; }
+
+    // Number of distinct names interned, including the empty one
+    static size_t GetCount();
+
+private:
+    uint32_t m_id = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const SS_Name& name) {
+    return os << name.View();
+}
+
+namespace std {
+    template <> struct hash<SS_Name> {
+        size_t operator()(const SS_Name& name) const { return name.GetID(); }
+    };
+}
+
+#endif
@@ -9,8 +9,25 @@
 #include "../graphics/ga_material.h"
 #include "ss_pins.hpp"
 #include "ss_boilerplate.hpp"
+#include "ss_hash.hpp"
+#include "ss_node_factory.hpp"
+#include "ss_text_metrics.hpp"
+
+namespace {
+    // Fixed node and pin names, interned once
+    const SS_Name k_constantOutName("CONST OUT");
+    const SS_Name k_paramOutName("PARAM OUT");
+    const SS_Name k_vectorName("VECTOR");
+    const SS_Name k_swizzleNames[] = { SS_Name("x"), SS_Name("y"), SS_Name("z"), SS_Name("w") };
+    const SS_Name k_terminalFragName("TERMINAL FRAG           ");
+    const SS_Name k_terminalVertName("TERMINAL VERTEX         ");
+}
+
+int Base_GraphNode::s_nextTopoIndex = 0;
+uint32_t Base_GraphNode::s_dirtyEpoch = 0;
 
 Base_GraphNode::~Base_GraphNode() {
+    if (m_dirtySet) m_dirtySet->erase(this);
     if (m_nodesRenderedTexture != NODE_TEXTURE_NULL) {
         glDeleteTextures(1, &m_nodesRenderedTexture);
         glDeleteTextures(1, &m_nodesDepthTexture);
@@ -18,10 +35,10 @@ Base_GraphNode::~Base_GraphNode() {
 }
 
 
-Builtin_GraphNode::Builtin_GraphNode(Builtin_Node_Data& data, int id, ImVec2 pos) {
+Builtin_GraphNode::Builtin_GraphNode(const Builtin_Node_Data& data, int id, ImVec2 pos) {
     m_id = id;
     m_oldPos = m_pos = pos;
-        _inliner = data.in_liner;
+    m_definition = data.index;
     m_name = data._name;
 
     m_numInput = data.in_vars.size();
@@ -30,24 +47,26 @@ Builtin_GraphNode::Builtin_GraphNode(Builtin_Node_Data& data, int id, ImVec2 pos
     m_outputPins = std::vector<Base_OutputPin>(m_numOutput);
 
         for (int i = 0; i < m_numInput; ++i) {
-            GLSL_TYPE type = data.in_vars[i].first;
-            std::string name = data.in_vars[i].second;
             m_inputPins[i].bInput = true;
             m_inputPins[i].index = i;
             m_inputPins[i].owner = this;
-            m_inputPins[i].type = type;
-            m_inputPins[i]._name = name;
+            m_inputPins[i].type = data.in_vars[i].first;
+            m_inputPins[i]._name = data.in_vars[i].second;
         }
         for (int o = 0; o < m_numOutput; ++o) {
-            GLSL_TYPE type = data.out_vars[o].first;
-            std::string name = data.out_vars[o].second;
             m_outputPins[o].bInput = false;
             m_outputPins[o].index = o;
             m_outputPins[o].owner = this;
-            m_outputPins[o].type = type;
-            m_outputPins[o]._name = name;
+            m_outputPins[o].type = data.out_vars[o].first;
+            m_outputPins[o]._name = data.out_vars[o].second;
         }
-    }
+}
+
+const Builtin_Node_Data& Builtin_GraphNode::GetDefinition() const {
+    const Builtin_Node_Data* data = SS_Node_Factory::GetBuiltinNodeData(m_definition);
+    assert(data);
+    return *data;
+}
 
 
 
@@ -63,105 +82,213 @@ inline bool is_gentype(unsigned int type) {
     return (type & GLSL_GenType);
 }
 
-void Base_GraphNode::PropagateGentypeInSubgraph(Base_Pin* start_pin, unsigned int type) {
-    std::unordered_set<int> processed_ids;      // only prop length
-    PropogateGentypeInSubgraph_Rec(start_pin, type & GLSL_LenMask, processed_ids);
-}
-
-void Base_GraphNode::PropogateGentypeInSubgraph_Rec(Base_Pin* start_pin,
-                                                    unsigned int type, std::unordered_set<int>& processed_ids) {
-    // if we reach non-generic parts
-    if (!is_gentype(start_pin->type.type_flags)) return;
-
-    // Stop if processed already and add to processed
-    if (processed_ids.find(m_id) != processed_ids.end()) return;
-    processed_ids.insert(m_id);
-    // INPUT
-    for (int i = 0; i < m_numInput; ++i) {
-        if (!is_gentype(m_inputPins[i].type.type_flags)) continue;
-
-        // Intersect generic part of pin with restrictive
-        unsigned int gen_len_intersect = type & GLSL_LenMask;
-        m_inputPins[i].type.type_flags &= (~GLSL_LenMask); // clear len mask
-        m_inputPins[i].type.type_flags |= gen_len_intersect; // set len mask
-
-        if (not m_inputPins[i].input) continue;
-        m_inputPins[i].input->owner->PropogateGentypeInSubgraph_Rec(
-                m_inputPins[i].input, type, processed_ids);
-    } 
-    // OUTPUT
-    for (int o = 0; o < m_numOutput; ++o) {
-        if (!is_gentype(m_outputPins[o].type.type_flags)) continue;
-
-        // Intersect generic part of pin with restrictive
-        unsigned int gen_len_intersect = type & GLSL_LenMask;
-        m_outputPins[o].type.type_flags &= ~GLSL_LenMask; // clear len mask
-        m_outputPins[o].type.type_flags |= gen_len_intersect; // set len mask
-
-        for (Base_InputPin* i_pin : m_outputPins[o].output) {
-            if (!i_pin) continue;
-            i_pin->owner->PropogateGentypeInSubgraph_Rec(i_pin, type, processed_ids);
+Base_GraphNode* Base_GraphNode::FindGentypeRoot() {
+    Base_GraphNode* node = this;
+    while (node->m_gentypeParent != node) {
+        // Path halving, keeps the trees flat
+        node->m_gentypeParent = node->m_gentypeParent->m_gentypeParent;
+        node = node->m_gentypeParent;
+    }
+    return node;
+}
+
+Base_GraphNode* Base_GraphNode::JoinGentypeRoots(Base_GraphNode* a, Base_GraphNode* b) {
+    if (a == b) return a;
+    unsigned int len = a->GetGentypeLength() & b->GetGentypeLength();
+    if (a->m_gentypeRank < b->m_gentypeRank) std::swap(a, b);
+    b->m_gentypeParent = a;
+    if (a->m_gentypeRank == b->m_gentypeRank) ++a->m_gentypeRank;
+    // Splice the rings
+    std::swap(a->m_gentypeNext, b->m_gentypeNext);
+    a->m_gentypeLen = len;
+    return a;
+}
+
+unsigned int Base_GraphNode::GetOwnGentypeLength() const {
+    unsigned int len = GLSL_LenMask;
+    for (const Base_InputPin& pin : m_inputPins) {
+        if (is_gentype(pin.type.type_flags)) len &= (pin.type.type_flags & GLSL_GenType) >> GLSL_LenToGenPush;
+    }
+    for (const Base_OutputPin& pin : m_outputPins) {
+        if (is_gentype(pin.type.type_flags)) len &= (pin.type.type_flags & GLSL_GenType) >> GLSL_LenToGenPush;
+    }
+    return len;
+}
+
+unsigned int Base_GraphNode::GetGentypeLength() {
+    Base_GraphNode* root = FindGentypeRoot();
+    if (root->m_gentypeLen == 0) root->m_gentypeLen = root->GetOwnGentypeLength();
+    return root->m_gentypeLen;
+}
+
+void Base_GraphNode::ApplyGentypeLength(unsigned int len) {
+    std::vector<Base_GraphNode*> changed;
+    Base_GraphNode* node = this;
+    do {
+        bool type_changed = false;
+        auto setLength = [len, &type_changed](Base_Pin& pin) {
+            if (not is_gentype(pin.type.type_flags) or (pin.type.type_flags & GLSL_LenMask) == len) return;
+            pin.type.type_flags = (pin.type.type_flags & ~GLSL_LenMask) | len;
+            type_changed = true;
+        };
+        for (Base_InputPin& pin : node->m_inputPins) setLength(pin);
+        for (Base_OutputPin& pin : node->m_outputPins) setLength(pin);
+        if (type_changed) {
+            node->InvalidateLayout();
+            changed.push_back(node);
+        }
+        node = node->m_gentypeNext;
+    } while (node != this);
+    // Declared types are part of the emitted code, so the cached code is stale
+    PropagateBuildDirty(changed);
+}
+
+void Base_GraphNode::UniteGentypes(Base_GraphNode* a, Base_GraphNode* b) {
+    unsigned int a_len = a->GetGentypeLength();
+    unsigned int b_len = b->GetGentypeLength();
+    // Only a class whose length narrows has pins to update
+    if (a_len != (a_len & b_len)) a->ApplyGentypeLength(a_len & b_len);
+    if (b_len != (a_len & b_len)) b->ApplyGentypeLength(a_len & b_len);
+    JoinGentypeRoots(a->FindGentypeRoot(), b->FindGentypeRoot());
+}
+
+void Base_GraphNode::RestrictGentype(unsigned int len) {
+    unsigned int old_len = GetGentypeLength();
+    if ((old_len & len) == old_len) return;
+    FindGentypeRoot()->m_gentypeLen = old_len & len;
+    ApplyGentypeLength(old_len & len);
+}
+
+void Base_GraphNode::SplitGentype(bool updatePins) {
+    // Every member starts over in a class of its own
+    std::vector<Base_GraphNode*> members;
+    Base_GraphNode* node = this;
+    do {
+        members.push_back(node);
+        node = node->m_gentypeNext;
+    } while (node != this);
+    for (Base_GraphNode* member : members) {
+        member->m_gentypeParent = member->m_gentypeNext = member;
+        member->m_gentypeRank = 0;
+        member->m_gentypeLen = member->GetOwnGentypeLength();
+    }
+    // Join again through the connections left, generic neighbours are all members of the old class
+    auto joinThrough = [](Base_GraphNode* member, const Base_Pin& own, const Base_Pin& other) {
+        if (not is_gentype(own.type.type_flags)) return;
+        if (is_gentype(other.type.type_flags))
+            JoinGentypeRoots(member->FindGentypeRoot(), other.owner->FindGentypeRoot());
+        else
+            member->FindGentypeRoot()->m_gentypeLen &= other.type.type_flags & GLSL_LenMask;
+    };
+    SS_Edge_Table* edges = m_edgeTable;
+    for (Base_GraphNode* member : members) {
+        for (const Base_InputPin& in_pin : member->m_inputPins) {
+            if (in_pin.input) joinThrough(member, in_pin, *in_pin.input);
         }
+        if (not edges) continue;
+        edges->ForEachOutEdge(member->m_id, [&](uint32_t e) {
+            joinThrough(member, member->m_outputPins[edges->GetSourcePin(e)], edges->GetInputPin(e));
+        });
+    }
+    if (not updatePins) return;
+    for (Base_GraphNode* member : members) {
+        if (member->m_gentypeParent == member) member->ApplyGentypeLength(member->m_gentypeLen);
     }
 }
 
 void Base_GraphNode::PropagateBuildDirty() {
-    m_isBuildDirty = true;
+    PropagateBuildDirty({ this });
+}
+
+void Base_GraphNode::PropagateBuildDirty(const std::vector<Base_GraphNode*>& nodes) {
+    if (nodes.empty()) return;
+    // Nodes are stamped with this propagation's epoch when first reached
+    uint32_t epoch = ++s_dirtyEpoch;
+    std::vector<Base_GraphNode*> worklist(nodes);
+    for (Base_GraphNode* node : nodes)
+        node->m_dirtyEpoch = epoch;
+    while (not worklist.empty()) {
+        Base_GraphNode* node = worklist.back();
+        worklist.pop_back();
+        node->m_isCodeDirty = true;
+        node->m_isBuildDirty = true;
+        node->m_isBuildSubmitted = false;
+        node->UpdateDirtySet();
+        SS_Edge_Table* edges = node->m_edgeTable;
+        if (not edges) continue;
+        edges->ForEachOutEdge(node->m_id, [&](uint32_t e) {
+            Base_GraphNode* next = edges->GetInputPin(e).owner;
+            if (next->m_dirtyEpoch == epoch) return;
+            next->m_dirtyEpoch = epoch;
+            worklist.push_back(next);
+        });
+    }
+}
+
+void Base_GraphNode::UpdateCodeCache() {
+    if (!m_isCodeDirty) return;
+    // Folded nodes generate literals in place of code
+    m_constantOutputs.clear();
+    if (not EvaluateConstantOutputs(m_constantOutputs))
+        m_constantOutputs.clear();
+    // Rewrite the caches in place, reusing their capacity
+    m_cachedText.Clear();
+    ProcessForCode(m_cachedText);
+    m_cachedCodeEnd = (uint32_t)m_cachedText.Size();
+    m_cachedOutputEnds.resize(m_numOutput);
     for (int o = 0; o < m_numOutput; ++o) {
-        for (Base_InputPin* i_pin : m_outputPins[o].output)
-            i_pin->owner->PropagateBuildDirty();
+        WriteOutput(o, m_cachedText);
+        m_cachedOutputEnds[o] = (uint32_t)m_cachedText.Size();
     }
+    m_structuralHash = ComputeStructuralHash();
+    m_isCodeDirty = false;
+    UpdateDirtySet();
 }
 
-
-// RETURNS LEN (NON-GEN) SET FOR MOST RESTRICTIVE GENTYPES
-    // If start_pin is non-generic, only LEN will be set
-unsigned int Base_GraphNode::GetMostRestrictiveGentypeInSubgraph(Base_Pin* start_pin) {
-    if (!is_gentype(start_pin->type.type_flags)) return start_pin->type.type_flags & GLSL_LenMask;
-
-    std::unordered_set<int> processed_ids;
-    // Intersect only the len-not-gen-type portion of the pin type
-    unsigned int start_type = (start_pin->type.type_flags & GLSL_GenType) >> GLSL_LenToGenPush;
-    unsigned int restrict_type = GetMostRestrictiveGentypeInSubgraph_Rec(start_pin, processed_ids);
-    restrict_type &= start_type;
-    return restrict_type;
+bool Base_GraphNode::GetConstantInputs(std::vector<Folded_Value>& ins) const {
+    ins.resize(m_numInput);
+    for (int i = 0; i < m_numInput; ++i) {
+        const Base_OutputPin* o_pin = m_inputPins[i].input;
+        if (not o_pin) {
+            if (not SS_Folding::MakeDefaultValue(m_inputPins[i].type, ins[i])) return false;
+        } else if (o_pin->owner->HasConstantOutputs()) {
+            ins[i] = o_pin->owner->GetConstantOutput(o_pin->index);
+        } else return false;
+    }
+    return true;
 }
 
+bool Base_GraphNode::MakeConstantOutputs(std::vector<Folded_Value>& outs) const {
+    outs.resize(m_numOutput);
+    for (int o = 0; o < m_numOutput; ++o)
+        if (not SS_Folding::MakeValue(m_outputPins[o].type, outs[o])) return false;
+    return true;
+}
 
-unsigned int Base_GraphNode::GetMostRestrictiveGentypeInSubgraph_Rec(Base_Pin* start_pin, std::unordered_set<int>& processed_ids) {
-    if (!is_gentype(start_pin->type.type_flags)) return start_pin->type.type_flags & GLSL_LenMask;
-    
-    // Stop if processed already and add to processed
-    if (processed_ids.find(m_id) != processed_ids.end()) return GLSL_LenMask;
-    processed_ids.insert(m_id);
-
-    // set starting most restrictive type as gentype portion of type, shifted to moddable LenType
-    unsigned int most_res_gen_type = (start_pin->type.type_flags & GLSL_GenType) >> GLSL_LenToGenPush;
-    // unsigned int type_type = start_pin->type.type_flags & GLSL_TypeMask;
-
-    // INPUT
-    for (int i = 0; i < m_numInput; ++i) {
-        if (!is_gentype(m_inputPins[i].type.type_flags)) continue; // dont process non-generic pins in the node
-        Base_OutputPin* o_pin = m_inputPins[i].input;
-        if (!o_pin) continue; // output pin exists
-
-        unsigned int res_type = GetMostRestrictiveGentypeInSubgraph_Rec(o_pin, processed_ids);
-        most_res_gen_type &= res_type; // Intersect only for len, non-gen
-    } 
-    // OUTPUT
-    for (int o = 0; o < m_numOutput; ++o) {
-        if (!is_gentype(m_outputPins[o].type.type_flags)) continue; // dont process non-generic pins in the node
-
-        for (Base_InputPin* i_pin : m_outputPins[o].output) {
-            if (!i_pin) continue; // pin exists
+uint64_t Base_GraphNode::HashDefinition(uint64_t hash) const {
+    hash = SS_Hash::Value(hash, (int)GetNodeType());
+    return SS_Hash::Value(hash, m_name.Hash());
+}
 
-            unsigned int res_type = GetMostRestrictiveGentypeInSubgraph_Rec(i_pin, processed_ids);
-            most_res_gen_type &= res_type; // Intersect only for len, non-gen
+uint64_t Base_GraphNode::ComputeStructuralHash() const {
+    uint64_t hash = HashDefinition(SS_Hash::Seed);
+    for (const Base_InputPin& in_pin : m_inputPins) {
+        if (in_pin.input) {
+            // Inputs are hashed before us in topological order
+            hash = SS_Hash::Value(hash, in_pin.input->owner->GetStructuralHash());
+            hash = SS_Hash::Value(hash, in_pin.input->index);
+        } else {
+            // Unconnected pins read a default value decided by their type
+            hash = SS_Hash::Value(hash, in_pin.type.type_flags);
         }
     }
-    return most_res_gen_type;
+    // Resolved gentypes change the declared types
+    for (const Base_OutputPin& out_pin : m_outputPins)
+        hash = SS_Hash::Value(hash, out_pin.type.type_flags);
+    return hash;
 }
 
+
 void checkCompileErrors(GLuint shader, const std::string& type)
 {
     GLint success;
@@ -182,9 +309,14 @@ void checkCompileErrors(GLuint shader, const std::string& type)
 }
 
 bool Base_GraphNode::GenerateIntermediateResultFrameBuffers() {
+    // Every mip is rendered to directly, the base level selects which one is displayed
     glGenTextures(1, &m_nodesRenderedTexture);
     glBindTexture(GL_TEXTURE_2D, m_nodesRenderedTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 256,  256, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    for (int mip = 0; mip < NODE_PREVIEW_MIPS; ++mip) {
+        glTexImage2D(GL_TEXTURE_2D, mip, GL_RGB, NODE_PREVIEW_SIZE >> mip, NODE_PREVIEW_SIZE >> mip, 0, GL_RGB,
+                     GL_UNSIGNED_BYTE, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, NODE_PREVIEW_MIPS - 1);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -192,7 +324,8 @@ bool Base_GraphNode::GenerateIntermediateResultFrameBuffers() {
 
     glGenTextures(1, &m_nodesDepthTexture);
     glBindTexture(GL_TEXTURE_2D, m_nodesDepthTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, 256, 256, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, NODE_PREVIEW_SIZE, NODE_PREVIEW_SIZE, 0, GL_DEPTH_STENCIL,
+                 GL_UNSIGNED_INT_24_8, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -200,18 +333,55 @@ bool Base_GraphNode::GenerateIntermediateResultFrameBuffers() {
     return true;
 }
 
-void Base_GraphNode::CompileIntermediateCode(std::unique_ptr<ga_material>&& material) {
-    m_cube.reset(new ga_cube_component(m_vertStr, m_fragStr, std::move(material)));
-    m_isBuildDirty = false;
+void Base_GraphNode::CompileIntermediateCode(std::unique_ptr<ga_material>&& material,
+                                             const ga_shader_source& vert_source, const ga_shader_source& frag_source) {
+    // A newer build replaces one still in flight
+    m_pendingCube.reset(new ga_cube_component(vert_source, frag_source, std::move(material)));
+    m_isBuildSubmitted = true;
     //unsigned int err = glGetError();
 }
 
-void Base_GraphNode::DrawIntermediateResult(unsigned int framebuffer, const std::vector<std::unique_ptr<Parameter_Data>>& params) {
+bool Base_GraphNode::PollIntermediateProgram() {
+    if (not m_pendingCube) return true;
+    bool linked;
+    if (not m_pendingCube->_material->poll(linked)) return false;
+    if (linked) {
+        m_cube = std::move(m_pendingCube);
+        m_isBuildDirty = false;
+        UpdateDirtySet();
+    } else {
+        m_pendingCube.reset();
+    }
+    m_isBuildSubmitted = false;
+    return true;
+}
+
+void Base_GraphNode::FinishSharedIntermediateProgram(bool linked) {
+    // A node changed since the submit still needs the next program
+    if (linked and m_isBuildSubmitted) {
+        m_isBuildDirty = false;
+        UpdateDirtySet();
+    }
+    m_isBuildSubmitted = false;
+}
+
+void Base_GraphNode::DrawIntermediateResult(unsigned int framebuffer, const std::vector<std::unique_ptr<Parameter_Data>>& params,
+                                            ga_cube_component* preview, int mip) {
+    if (m_nodesRenderedTexture == NODE_TEXTURE_NULL)
+        GenerateIntermediateResultFrameBuffers();
+    assert(mip >= 0 && mip < NODE_PREVIEW_MIPS);
+    if (mip != m_previewMip) {
+        glBindTexture(GL_TEXTURE_2D, m_nodesRenderedTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, mip);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        m_previewMip = mip;
+    }
 
     glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
 
+    // The depth texture stays full size, rendering is limited to the smaller color mip
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_nodesDepthTexture, 0);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_nodesRenderedTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_nodesRenderedTexture, mip);
     
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         std::cout << "Depth texture: " << m_nodesDepthTexture << ", Render Texture: " << m_nodesRenderedTexture << std::endl;
@@ -219,30 +389,29 @@ void Base_GraphNode::DrawIntermediateResult(unsigned int framebuffer, const std:
     }
 
     glEnable(GL_DEPTH_TEST);
-    glViewport(0, 0, 256, 256);
-    if (m_isBuildDirty)
+    glViewport(0, 0, NODE_PREVIEW_SIZE >> mip, NODE_PREVIEW_SIZE >> mip);
+    if (NeedsIntermediateProgram())
         glClearColor(0.8f, 0.1f, 0.1f, 1);
     else
         glClearColor(0.2f, 0.2f, 0.4f, 1);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-    if (m_cube) {
+    ga_cube_component* cube = preview ? preview : m_cube.get();
+    if (cube) {
         ga_mat4f view{};
         view.make_lookat_rh(ga_vec3f{2.0f, 2.0f, 3.0f}, ga_vec3f{0, 0, 0}, ga_vec3f{0, 1, 0});
         ga_mat4f perspective{};
         perspective.make_perspective_rh(ga_degrees_to_radians(45.0f), 1.0f, 0.1f, 10000.0f);
 
-        m_cube->_material->bind(view, perspective, m_cube->_transform, params);
-        glBindVertexArray(m_cube->_vao);
-        glDrawElements(GL_TRIANGLES, m_cube->_index_count, GL_UNSIGNED_SHORT, 0);
+        cube->_material->bind(view, perspective, cube->_transform, params);
+        if (preview)
+            preview->_material->_program->get_uniform("u_preview_node").set(m_id);
+        glBindVertexArray(cube->_vao);
+        glDrawElements(GL_TRIANGLES, cube->_index_count, GL_UNSIGNED_SHORT, 0);
     }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void Base_GraphNode::SetShaderCode(const std::string& frag_shad, const std::string& vert_shad) {
-    m_fragStr = frag_shad;
-    m_vertStr = vert_shad;
-}
 
 
 
@@ -276,22 +445,33 @@ float pin_y_step = 2;
 unsigned rect_color = 0xff444444;
 float rect_rounding = 10;
 
-void Base_GraphNode::SetBounds(float scale) {
+void Base_GraphNode::MarkLayoutChanged() {
+    if (m_nodeStore) m_nodeStore->MarkLayoutChanged(m_id);
+}
+
+void Base_GraphNode::SetBounds() {
+    float font_size = ImGui::GetFontSize();
+    if (not m_isLayoutDirty and font_size == m_layoutFontSize) return;
+    m_isLayoutDirty = false;
+    m_layoutFontSize = font_size;
+
     // set main name size
-    m_nameRelSize = ImGui::CalcTextSize(m_name.c_str());
+    m_nameRelSize = SS_Text_Metrics::GetTextSize(m_name);
 
     // set pin sizes and accumulate main rect size
     float in_x_max = 0, out_x_max = 0;
     float in_y = 0, out_y = 0;
     for (int i = 0; i < m_numInput; ++i) {
-        m_inPinSizes.push_back(m_inputPins[i].GetSize(pin_circle_offset, pin_border));
-        in_x_max = std::max(in_x_max, m_inPinSizes.back().x);
-        in_y += m_inPinSizes.back().y + pin_y_step;
+        m_inputPins[i].textSize = SS_Text_Metrics::GetTextSize(m_inputPins[i]._name);
+        ImVec2 pin_size = m_inputPins[i].GetSize(pin_circle_offset, pin_border);
+        in_x_max = std::max(in_x_max, pin_size.x);
+        in_y += pin_size.y + pin_y_step;
     }
     for (int o = 0; o < m_numOutput; ++o) {
-        m_outPinSizes.push_back(m_outputPins[o].GetSize(pin_circle_offset, pin_border));
-        out_x_max = std::max(out_x_max, m_outPinSizes.back().x);
-        out_y += m_outPinSizes.back().y + pin_y_step;
+        m_outputPins[o].textSize = SS_Text_Metrics::GetTextSize(m_outputPins[o]._name);
+        ImVec2 pin_size = m_outputPins[o].GetSize(pin_circle_offset, pin_border);
+        out_x_max = std::max(out_x_max, pin_size.x);
+        out_y += pin_size.y + pin_y_step;
     }
     
     // set main rect size
@@ -302,15 +482,15 @@ void Base_GraphNode::SetBounds(float scale) {
     // Get relative (to upper left) position of pins
     ImVec2 pin_pos = ImVec2(BORDER, m_nameRelSize.y + line_height + BORDER);
     for (int i = 0; i < m_numInput; ++i) {
-        ImVec2 pin_size = m_inPinSizes[i];
-        m_inPinRelPos.push_back(pin_pos);
+        ImVec2 pin_size = m_inputPins[i].GetSize(pin_circle_offset, pin_border);
+        m_inputPins[i].relPos = pin_pos;
         pin_pos.y += (pin_size.y + pin_y_step);
     }
 
     pin_pos = ImVec2(m_rectSize.x, m_nameRelSize.y + line_height + BORDER);
     for (int o = 0; o < m_numOutput; ++o) {
-        ImVec2 pin_size = m_outPinSizes[o];
-        m_outPinRelPos.push_back(pin_pos - ImVec2(pin_size.x + BORDER, 0));
+        ImVec2 pin_size = m_outputPins[o].GetSize(pin_circle_offset, pin_border);
+        m_outputPins[o].relPos = pin_pos - ImVec2(pin_size.x + BORDER, 0);
         pin_pos.y += (pin_size.y + pin_y_step);
     }
 
@@ -341,52 +521,68 @@ bool Base_GraphNode::CanConnectPins(Base_InputPin* in_pin, Base_OutputPin* out_p
 }
 
 
-void Base_GraphNode::Draw(ImDrawList* drawList, ImVec2 pos_offset, bool is_hover) {
+void Base_GraphNode::Draw(ImDrawList* drawList, SS_Canvas_Renderer& shapes, const SS_Canvas_View& view, bool is_hover) {
     // m_pos should be middle of node, but this pos is actually the upper left
-    ImVec2 pos = m_pos - ImVec2(m_rectSize.x * 0.5f, m_rectSize.y * 0.5f) + pos_offset;
+    ImVec2 pos = view.ToScreen(m_pos - ImVec2(m_rectSize.x * 0.5f, m_rectSize.y * 0.5f));
+    float zoom = view.zoom;
+    ImVec2 rect_size = ImVec2(m_rectSize.x * zoom, m_rectSize.y * zoom);
+    // The display panel and preview hang below the rect
+    ImVec2 display_min = pos + ImVec2(m_displayPanelRelPos.x * zoom, (m_displayPanelRelPos.y + m_displayPanelRelSize.y) * zoom);
+    ImVec2 display_max = display_min + ImVec2(rect_size.x, rect_size.x);
 
-    // Draw main rect
     unsigned int col = is_hover ? 0xffff4444 : 0xffaa4444;
-    drawList->AddRectFilled(pos, pos + m_rectSize, col, rect_rounding);
-    drawList->AddText(pos + ImVec2(BORDER, BORDER), 0xffffffff, m_name.c_str());
-    drawList->AddLine(pos + ImVec2(0, m_nameRelSize.y + BORDER), pos + ImVec2(m_rectSize.x, m_nameRelSize.y + BORDER), 0xffffffff, 2.0f);
+    if (not view.IsDetailed()) {
+        // Too small to read, a flat rect and the preview only
+        shapes.AddRect(pos, pos + rect_size, col);
+        if (CanDrawIntermedImage() and m_isDisplayUp)
+            drawList->AddImage(BindAndGetImageTexture(), display_min, display_max);
+        return;
+    }
+
+    // Draw main rect
+    float font_size = ImGui::GetFontSize() * zoom;
+    shapes.AddRect(pos, pos + rect_size, col, rect_rounding * zoom);
+    drawList->AddText(ImGui::GetFont(), font_size, pos + ImVec2(BORDER * zoom, BORDER * zoom), 0xffffffff,
+                      m_name.c_str(), m_name.c_str() + m_name.size());
+    float line_y = (m_nameRelSize.y + BORDER) * zoom;
+    float line_half = line_thickness * zoom * 0.5f;
+    shapes.AddRect(pos + ImVec2(0, line_y - line_half), pos + ImVec2(rect_size.x, line_y + line_half), 0xffffffff);
 
     // For each input, ask it to be drawn at proper location
     for (int i = 0; i < m_numInput; ++i) {
-        m_inputPins[i].Draw(drawList, m_inPinRelPos[i] + pos, pin_circle_offset, pin_border);
+        ImVec2 pin_pos = pos + ImVec2(m_inputPins[i].relPos.x * zoom, m_inputPins[i].relPos.y * zoom);
+        m_inputPins[i].Draw(drawList, shapes, pin_pos, pin_circle_offset, pin_border, zoom);
     }
 
     // For each output, ask it to be drawn at proper location
     for (int o = 0; o < m_numOutput; ++o) {
-        m_outputPins[o].Draw(drawList, m_outPinRelPos[o] + pos, pin_circle_offset, pin_border);
+        ImVec2 pin_pos = pos + ImVec2(m_outputPins[o].relPos.x * zoom, m_outputPins[o].relPos.y * zoom);
+        m_outputPins[o].Draw(drawList, shapes, pin_pos, pin_circle_offset, pin_border, zoom);
     }
 
     if (CanDrawIntermedImage()) {
-        drawList->AddRectFilled(m_displayPanelRelPos + pos, m_displayPanelRelPos + m_displayPanelRelSize + pos,
-                                m_isDisplayUp ? 0xffffffff : 0xaaaaaaaa, 7);
-        if (m_isDisplayUp) {
-            ImVec2 display_min = m_displayPanelRelPos + ImVec2(0, m_displayPanelRelSize.y);
-            ImVec2 display_max = display_min + ImVec2(m_rectSize.x, m_rectSize.x);
-
-            drawList->AddImage(BindAndGetImageTexture(), display_min + pos, display_max + pos);
-        }
+        ImVec2 panel_min = pos + ImVec2(m_displayPanelRelPos.x * zoom, m_displayPanelRelPos.y * zoom);
+        ImVec2 panel_max = panel_min + ImVec2(m_displayPanelRelSize.x * zoom, m_displayPanelRelSize.y * zoom);
+        shapes.AddRect(panel_min, panel_max, m_isDisplayUp ? 0xffffffff : 0xaaaaaaaa, 7 * zoom);
+        if (m_isDisplayUp)
+            drawList->AddImage(BindAndGetImageTexture(), display_min, display_max);
     }
 }
 
-void Base_GraphNode::DrawOutputConnects(ImDrawList* drawList, ImVec2 offset) {
-    for (int o = 0; o < m_numOutput; ++o) {
-        Base_OutputPin* o_pin = &m_outputPins[o];
-        ImU32 color = SS_Parser::GLSLTypeToColor(o_pin->type);
-
-        for (Base_InputPin* i_pin : o_pin->output) {
-            float r;
-            ImVec2 o_pos = o_pin->GetPinPos(pin_circle_offset, pin_border, &r);
-            o_pos = o_pos - ImVec2(r / 2, r / 2) + offset;
-            ImVec2 i_pos = i_pin->GetPinPos(pin_circle_offset, pin_border, &r);
-            i_pos = i_pos - ImVec2(r / 2, r / 2) + offset;
-            drawList->AddBezierCurve(o_pos, o_pos + ImVec2(50, 0), i_pos - ImVec2(50, 0), i_pos, color, 3);
-        }
+void Base_GraphNode::DrawConnection(SS_Canvas_Renderer& shapes, Base_OutputPin& o_pin, Base_InputPin& i_pin,
+                                    const SS_Canvas_View& view) {
+    ImU32 color = SS_Parser::GLSLTypeToColor(o_pin.type);
+    float r;
+    ImVec2 o_pos = o_pin.GetPinPos(pin_circle_offset, pin_border, &r);
+    o_pos = view.ToScreen(o_pos - ImVec2(r / 2, r / 2));
+    ImVec2 i_pos = i_pin.GetPinPos(pin_circle_offset, pin_border, &r);
+    i_pos = view.ToScreen(i_pos - ImVec2(r / 2, r / 2));
+    if (not view.IsDetailed()) {
+        shapes.AddWire(o_pos, o_pos, i_pos, i_pos, color, 1);
+        return;
     }
+    float bend = 50 * view.zoom;
+    shapes.AddWire(o_pos, o_pos + ImVec2(bend, 0), i_pos - ImVec2(bend, 0), i_pos, color, 3 * view.zoom);
 }
 
 bool Base_GraphNode::IsHovering(ImVec2 mouse_pos) {
@@ -405,21 +601,19 @@ Base_Pin* Base_GraphNode::GetHoveredPin(ImVec2 mouse_pos) {
     Base_Pin* pin = nullptr;
     ImVec2 ul = m_pos - ImVec2(m_rectSize.x / 2, m_rectSize.y / 2);
     for (int i = 0; i < m_numInput; ++i) {
-        ImVec2 pin_pos = ul + m_inPinRelPos[i];
-        if (contains(pin_pos, pin_pos + m_inPinSizes[i], mouse_pos))
+        ImVec2 pin_pos = ul + m_inputPins[i].relPos;
+        if (contains(pin_pos, pin_pos + m_inputPins[i].GetSize(pin_circle_offset, pin_border), mouse_pos))
             pin = &m_inputPins[i];
     }
     for (int o = 0; o < m_numOutput; ++o) {
-        ImVec2 pin_pos = ul + m_outPinRelPos[o];
-        if (contains(pin_pos, pin_pos + m_outPinSizes[o], mouse_pos))
+        ImVec2 pin_pos = ul + m_outputPins[o].relPos;
+        if (contains(pin_pos, pin_pos + m_outputPins[o].GetSize(pin_circle_offset, pin_border), mouse_pos))
             pin = &m_outputPins[o];
     }
 
     if (pin) {
         ImGui::BeginTooltip();
-        std::string s = SS_Parser::GLSLTypeToString(pin->type);
-        
-        ImGui::Text("%s", s.c_str());
+        ImGui::Text("%s", SS_Parser::GetGLSLTypeName(pin->type).c_str());
         ImGui::EndTooltip();
     }
     return pin;
@@ -441,83 +635,74 @@ void Base_GraphNode::DisconnectAllPins() {
             PinOps::DisconnectPins(&node->m_inputPins[i], node->m_inputPins[i].input, true);
     }
 
-    for (int o = 0; o < node->m_numOutput; ++o) {
-        Base_OutputPin* o_pin = &node->m_outputPins[o];
-        std::vector<Base_InputPin*> output_COPY(node->m_outputPins[o].output);
-        for (Base_InputPin* i_pin : output_COPY) {
-            PinOps::DisconnectPins(i_pin, o_pin, true);
-        }
-    }
+    for (int o = 0; o < node->m_numOutput; ++o)
+        node->m_outputPins[o].DisconnectAllFrom(true);
 }
 
 
 
-std::string Builtin_GraphNode::RequestOutput(int out_index) {
-    return pin_parse_out_names[out_index];
+uint64_t Builtin_GraphNode::HashDefinition(uint64_t hash) const {
+    hash = Base_GraphNode::HashDefinition(hash);
+    return SS_Hash::Value(hash, GetDefinition().in_liner.Hash());
 }
 
-std::string Builtin_GraphNode::ProcessForCode() {
-    pin_parse_out_names.clear();
-    // OUTPUT NAMES
-    for (int o = 0; o < m_numOutput; ++o)
-        pin_parse_out_names.push_back(SS_Parser::GetUniqueVarName(m_id, o, m_outputPins[o].type));
-    // INPUT NAMES
-    std::vector<std::string> in_pin_names;
-    for (int i = 0; i < m_numInput; ++i)
-        if (m_inputPins[i].input)
-            in_pin_names.push_back(m_inputPins[i].input->get_pin_output_name());
-        else
-            in_pin_names.push_back(SS_Parser::GLSLTypeToDefaultValue(m_inputPins[i].type));
-    
-    std::stringstream sss;
-    // make ouputs
-    int start_out = 0;
-    if (m_numOutput > 0 && _inliner.find("\%o1") == std::string::npos) {
-        start_out = 1;
-    }
-
-    // replace placeholders with output/input names
-    std::string temp_inliner = _inliner;
-    // OUTPUT
-    for (int o = start_out; o < m_numOutput; ++o) {
-        // VARIABLES
-        sss << SS_Parser::GLSLTypeToString(m_outputPins[o].type) << " " << pin_parse_out_names[o] << ";" << std::endl;
-        // IN THE FUNCTION
-        std::string rep = std::string("\%o") + (char)('1' + o);
-        auto str_it = temp_inliner.find(rep);
-        std::string fr = temp_inliner.substr(0, str_it);
-        std::string ba = temp_inliner.substr(str_it + 3);
-        temp_inliner = fr.append(pin_parse_out_names[o]).append(ba);
-    }
-    // INPUT
-    for (int i = 0; i < m_numInput; ++i) {
-        std::string rep = std::string("\%i") + (char)('1' + i);
-        while (true) {
-            auto str_it = temp_inliner.find(rep);
-            if (str_it == std::string::npos) break;
-            std::string fr = temp_inliner.substr(0, str_it);
-            std::string ba = temp_inliner.substr(str_it + 3);
-            temp_inliner = fr .append(in_pin_names[i]).append(ba);
-        }
-    }
-    // if we didn't replace the 'first' output placeholder then we use assignment directly
-    if (start_out == 1)
-        sss << SS_Parser::GLSLTypeToString(m_outputPins[0].type) << " " << pin_parse_out_names[0] << " = ";
-    // close out
-    sss << temp_inliner;
-    sss << ";";
-    return sss.str();
+bool Builtin_GraphNode::EvaluateConstantOutputs(std::vector<Folded_Value>& outs) const {
+    if (m_numOutput == 0 || not SS_Folding::CanFoldBuiltin(m_name)) return false;
+    // Shared by every node so folding stops allocating once warmed up, evaluations never nest
+    static std::vector<Folded_Value> ins;
+    if (not GetConstantInputs(ins) || not MakeConstantOutputs(outs)) return false;
+    return SS_Folding::EvaluateBuiltin(m_name, ins, outs);
 }
 
-Builtin_GraphNode::~Builtin_GraphNode() {
-    glDeleteTextures(1, &m_nodesRenderedTexture);
-    glDeleteTextures(1, &m_nodesDepthTexture);
+void Builtin_GraphNode::WriteOutput(int out_index, SS_Code_Writer& writer) {
+    if (HasConstantOutputs())
+        SS_Folding::WriteValueLiteral(writer, m_constantOutputs[out_index]);
+    else
+        SS_Parser::WriteUniqueVarName(writer, m_id, out_index);
+}
+
+void Builtin_GraphNode::ProcessForCode(SS_Code_Writer& code) {
+    // FOLDED, outputs are literals
+    if (HasConstantOutputs())
+        return;
+    const Inliner_Template& tmpl = GetDefinition().in_liner_template;
+    // DECLARE OUTPUTS passed into the inliner
+    for (int o = tmpl.assigns_first_output ? 1 : 0; o < m_numOutput; ++o) {
+        SS_Parser::WriteGLSLType(code, m_outputPins[o].type);
+        code << ' ';
+        SS_Parser::WriteUniqueVarName(code, m_id, o);
+        code << ";\n";
+    }
+    if (tmpl.assigns_first_output) {
+        SS_Parser::WriteGLSLType(code, m_outputPins[0].type);
+        code << ' ';
+        SS_Parser::WriteUniqueVarName(code, m_id, 0);
+        code << " = ";
+    }
+    // FILL TEMPLATE
+    for (const Inliner_Template::Token& token : tmpl.tokens) {
+        switch (token.kind) {
+            case Inliner_Template::LITERAL:
+                code << SS_String_View(tmpl.text.data() + token.index, token.length);
+                break;
+            case Inliner_Template::INPUT:
+                if (m_inputPins[token.index].input)
+                    code << m_inputPins[token.index].input->get_pin_output_name();
+                else
+                    SS_Parser::WriteDefaultValue(code, m_inputPins[token.index].type);
+                break;
+            case Inliner_Template::OUTPUT:
+                SS_Parser::WriteUniqueVarName(code, m_id, token.index);
+                break;
+        }
+    }
+    code << ';';
 }
 
-Constant_Node::Constant_Node(Constant_Node_Data& data, int id, ImVec2 pos) {
+Constant_Node::Constant_Node(const Constant_Node_Data& data, int id, ImVec2 pos) {
     m_id = id;
     m_oldPos = m_pos = pos;
-    m_name = data.m_name;
+    m_name = SS_Name(data.m_name);
 
     _data_gen = data.m_gentype;
     _data_type = data.m_type;
@@ -559,7 +744,7 @@ Constant_Node::Constant_Node(Constant_Node_Data& data, int id, ImVec2 pos) {
     m_outputPins[0].bInput = false;
     m_outputPins[0].index = 0;
     m_outputPins[0].owner = this;
-    m_outputPins[0]._name = "CONST OUT";
+    m_outputPins[0]._name = k_constantOutName;
 }
 
 void Vector_Op_Node::make_vec_break(int s) {
@@ -570,16 +755,15 @@ void Vector_Op_Node::make_vec_break(int s) {
     m_inputPins[0].bInput = true;
     m_inputPins[0].index = 0;
     m_inputPins[0].owner = this;
-    m_inputPins[0]._name = "VECTOR";
+    m_inputPins[0]._name = k_vectorName;
     m_inputPins[0].type = GLSL_TYPE(GLSL_AllTypes | (GLSL_Vec2 << (s - 2)), 1);
 
     m_outputPins = std::vector<Base_OutputPin>(m_numOutput);
-    const char* sw[] = { "x", "y", "z", "w" };
     for (int o = 0; o < m_numOutput; ++o) {
         m_outputPins[o].bInput = false;
         m_outputPins[o].index = o;
         m_outputPins[o].owner = this;
-        m_outputPins[o]._name = sw[o];
+        m_outputPins[o]._name = k_swizzleNames[o];
         m_outputPins[o].type = GLSL_TYPE(GLSL_AllTypes | GLSL_Scalar, 1);
     }
 }
@@ -592,29 +776,27 @@ void Vector_Op_Node::make_vec_make(int s) {
     m_outputPins[0].bInput = false;
     m_outputPins[0].index = 0;
     m_outputPins[0].owner = this;
-    m_outputPins[0]._name = "VECTOR";
+    m_outputPins[0]._name = k_vectorName;
     m_outputPins[0].type = GLSL_TYPE(GLSL_AllTypes | (GLSL_Vec2 << (s - 2)), 1);
 
     m_inputPins = std::vector<Base_InputPin>(m_numInput);
-    const char* sw[] = { "x", "y", "z", "w" };
     for (int i = 0; i < s; ++i) {
         m_inputPins[i].bInput = true;
         m_inputPins[i].index = i;
         m_inputPins[i].owner = this;
-        m_inputPins[i]._name = sw[i];
+        m_inputPins[i]._name = k_swizzleNames[i];
         m_inputPins[i].type = GLSL_TYPE(GLSL_AllTypes | GLSL_Scalar, 1);
     }
 }
 
-Vector_Op_Node::Vector_Op_Node(Vector_Op_Node_Data& data, int id, ImVec2 pos) {
+Vector_Op_Node::Vector_Op_Node(const Vector_Op_Node_Data& data, int id, ImVec2 pos) {
     m_id = id;
     m_oldPos = m_pos = pos;
-    m_name = data.m_name;
+    m_name = SS_Name(data.m_name);
 
-    m_inputPins = std::vector<Base_InputPin>(m_numInput);
-    m_outputPins = std::vector<Base_OutputPin>(m_numOutput);
+    // make_vec_break/make_vec_make set up the pins and their counts
     _vec_op = data.m_op;
-    
+
     switch (data.m_op) {
         case VEC_BREAK2_OP: make_vec_break(2); break;
         case VEC_BREAK3_OP: make_vec_break(3); break;
@@ -626,32 +808,54 @@ Vector_Op_Node::Vector_Op_Node(Vector_Op_Node_Data& data, int id, ImVec2 pos) {
 }
 
 
-std::string Vector_Op_Node::RequestOutput(int out_index) {
+uint64_t Vector_Op_Node::HashDefinition(uint64_t hash) const {
+    hash = Base_GraphNode::HashDefinition(hash);
+    return SS_Hash::Value(hash, (int)_vec_op);
+}
 
+bool Vector_Op_Node::EvaluateConstantOutputs(std::vector<Folded_Value>& outs) const {
+    if (not MakeConstantOutputs(outs)) return false;
     if (_vec_op == VEC_BREAK2_OP || _vec_op == VEC_BREAK3_OP || _vec_op == VEC_BREAK4_OP) {
-        const char* sw[] = { "x", "y", "z", "w" };
-        std::string var_name = m_inputPins[0].input->owner->RequestOutput(0);
-        return var_name + "." + sw[out_index];
-
+        const Base_OutputPin* o_pin = m_inputPins[0].input;
+        for (int o = 0; o < m_numOutput; ++o) {
+            if (not o_pin)
+                SS_Folding::MakeDefaultValue(m_outputPins[o].type, outs[o]);
+            else if (o_pin->owner->HasConstantOutputs())
+                outs[o].data[0] = o_pin->owner->GetConstantOutput(o_pin->index).data[o];
+            else return false;
+        }
+    } else {
+        // Unconnected make inputs are 0
+        for (int i = 0; i < m_numInput; ++i) {
+            const Base_OutputPin* o_pin = m_inputPins[i].input;
+            if (o_pin && not o_pin->owner->HasConstantOutputs()) return false;
+            outs[0].data[i] = o_pin ? o_pin->owner->GetConstantOutput(o_pin->index).data[0] : 0.0f;
+        }
+    }
+    return true;
+}
 
+void Vector_Op_Node::WriteOutput(int out_index, SS_Code_Writer& writer) {
+    if (HasConstantOutputs()) {
+        SS_Folding::WriteValueLiteral(writer, m_constantOutputs[out_index]);
+    } else if (_vec_op == VEC_BREAK2_OP || _vec_op == VEC_BREAK3_OP || _vec_op == VEC_BREAK4_OP) {
+        const char sw[] = { 'x', 'y', 'z', 'w' };
+        if (not m_inputPins[0].input)
+            SS_Parser::WriteDefaultValue(writer, m_outputPins[out_index].type);
+        else
+            writer << m_inputPins[0].input->get_pin_output_name() << '.' << sw[out_index];
     } else if (_vec_op == VEC_MAKE2_OP || _vec_op == VEC_MAKE3_OP || _vec_op == VEC_MAKE4_OP) {
-        std::string output = "vec";
-        output += std::to_string(m_numInput);
-        output += "(";
+        writer << "vec" << m_numInput << '(';
         for (int i = 0; i < m_numInput; ++i) {
-            if (m_inputPins[i].input) {
-                output += m_inputPins[i].input->get_pin_output_name();
-            } else {
-                output += "0";
-            }
-            output += ((i + 1 == m_numInput) ? ")" : ",");
+            if (m_inputPins[i].input)
+                writer << m_inputPins[i].input->get_pin_output_name();
+            else
+                writer << '0';
+            writer << ((i + 1 == m_numInput) ? ')' : ',');
         }
-        return output;
     }
-    return "";
 }
-std::string Vector_Op_Node::ProcessForCode() {
-    return "";
+void Vector_Op_Node::ProcessForCode(SS_Code_Writer& code) {
 }
 
 
@@ -662,7 +866,7 @@ Param_Node::Param_Node(Parameter_Data* data, int id, ImVec2 pos) {
     m_id = id;
     _paramID = data->GetID();
     m_oldPos = m_pos = pos;
-    m_name = data->GetName();
+    m_name = SS_Name(data->GetName());
 
     m_numOutput = 1;
     m_numInput = 0;
@@ -672,31 +876,26 @@ Param_Node::Param_Node(Parameter_Data* data, int id, ImVec2 pos) {
     m_outputPins[0].bInput = false;
     m_outputPins[0].index = 0;
     m_outputPins[0].owner = this;
-    m_outputPins[0]._name = "PARAM OUT";
+    m_outputPins[0]._name = k_paramOutName;
 }
 
-std::string Param_Node::RequestOutput(int out_index) {
-    return m_name;
+void Param_Node::WriteOutput(int out_index, SS_Code_Writer& writer) {
+    writer << m_name;
 }
-std::string Param_Node::ProcessForCode() {
-    return "";
+void Param_Node::ProcessForCode(SS_Code_Writer& code) {
 }
 
 void Param_Node::update_type_from_param(GLSL_TYPE type) {
     for (int o = 0; o < m_numOutput; ++o)
         m_outputPins[o].type = type;
-}
-
-Param_Node::~Param_Node()  {
-    glDeleteTextures(1, &m_nodesRenderedTexture);
-    glDeleteTextures(1, &m_nodesDepthTexture);
+    InvalidateLayout();
 }
 
 
-Boilerplate_Var_Node::Boilerplate_Var_Node(Boilerplate_Var_Data data, SS_Boilerplate_Manager* bp, int id, ImVec2 pos) {
+Boilerplate_Var_Node::Boilerplate_Var_Node(const Boilerplate_Var_Data& data, SS_Boilerplate_Manager* bp, int id, ImVec2 pos) {
     m_id = id;
     m_oldPos = m_pos = pos;
-    m_name = data._name;
+    m_name = SS_Name(data._name);
 
     frag_node = data.frag_only;
     _bpManager = bp;
@@ -710,22 +909,32 @@ Boilerplate_Var_Node::Boilerplate_Var_Node(Boilerplate_Var_Data data, SS_Boilerp
     m_outputPins[0].bInput = false;
     m_outputPins[0].index = 0;
     m_outputPins[0].owner = this;
-    m_outputPins[0]._name = data._name;
+    m_outputPins[0]._name = m_name;
 }
 
 
-std::string Boilerplate_Var_Node::RequestOutput(int out_index) {
-    return _bpManager->GetIntermediateResultCodeForVar(m_name);
+uint64_t Param_Node::HashDefinition(uint64_t hash) const {
+    hash = Base_GraphNode::HashDefinition(hash);
+    return SS_Hash::Value(hash, _paramID);
 }
-std::string Boilerplate_Var_Node::ProcessForCode() {
-    return "";
+
+uint64_t Terminal_Node::HashDefinition(uint64_t hash) const {
+    // Terminals are never shared
+    hash = Base_GraphNode::HashDefinition(hash);
+    return SS_Hash::Value(hash, m_id);
+}
+
+void Boilerplate_Var_Node::WriteOutput(int out_index, SS_Code_Writer& writer) {
+    writer << _bpManager->GetIntermediateResultCodeForVar(m_name);
+}
+void Boilerplate_Var_Node::ProcessForCode(SS_Code_Writer& code) {
 }
 
 Terminal_Node::Terminal_Node(const std::vector<Boilerplate_Var_Data>& terminal_pins, int id, ImVec2 pos) {
     m_id = id;
     m_oldPos = m_pos = pos;
     frag_node = terminal_pins.front().frag_only;
-    m_name = frag_node ? "TERMINAL FRAG           " : "TERMINAL VERTEX         ";
+    m_name = frag_node ? k_terminalFragName : k_terminalVertName;
 
     m_numInput = terminal_pins.size();
     m_numOutput = 0;
@@ -739,25 +948,19 @@ Terminal_Node::Terminal_Node(const std::vector<Boilerplate_Var_Data>& terminal_p
         m_inputPins[i].bInput = true;
         m_inputPins[i].index = i;
         m_inputPins[i].owner = this;
-        m_inputPins[i]._name = data._name;
+        m_inputPins[i]._name = SS_Name(data._name);
     }
 }
 
-Terminal_Node::~Terminal_Node()  {
-    glDeleteTextures(1, &m_nodesRenderedTexture);
-    glDeleteTextures(1, &m_nodesDepthTexture);
-}
-
 
-std::string Constant_Node::RequestOutput(int out_index) {
+void Constant_Node::WriteOutput(int out_index, SS_Code_Writer& writer) {
     GLSL_TYPE t = m_outputPins[0].type;
-    float* f_data = (float*)_data;
-    std::stringstream sss;
-    
+    const float* f_data = (const float*)_data;
+
     int size = 1;
     if (t.type_flags & GLSL_Scalar) {
-        sss << (*f_data);
-        return sss.str();
+        writer << (*f_data);
+        return;
     }
 
     if (t.type_flags & GLSL_Vec2)
@@ -767,19 +970,29 @@ std::string Constant_Node::RequestOutput(int out_index) {
     if (t.type_flags & GLSL_Vec4)
         size = 4;
     if (t.type_flags & GLSL_Mat) {
-        sss << "mat" << size << "(";
+        writer << "mat" << size << '(';
         size *= size;
     } else {
-        sss << "vec" << size << "(";
+        writer << "vec" << size << '(';
     }
     for (int f = 0; f < size; ++f) {
-        sss << f_data[f];
-        sss << ((f + 1 != size) ? ", " : ")");
+        writer << f_data[f];
+        writer << ((f + 1 != size) ? ", " : ")");
     }
+}
+bool Constant_Node::EvaluateConstantOutputs(std::vector<Folded_Value>& outs) const {
+    if (not _data || not MakeConstantOutputs(outs)) return false;
+    const auto* f_data = (const float*)_data;
+    std::copy(f_data, f_data + outs[0].Count(), outs[0].data);
+    return true;
+}
 
-    std::string s = sss.str();
-    return s;
+uint64_t Constant_Node::HashDefinition(uint64_t hash) const {
+    hash = Base_GraphNode::HashDefinition(hash);
+    // The literal is the constant's value
+    SS_String_View literal = GetCachedOutput(0);
+    return SS_Hash::Bytes(hash, literal.data, literal.size);
 }
-std::string Constant_Node::ProcessForCode() {
-    return "";
+
+void Constant_Node::ProcessForCode(SS_Code_Writer& code) {
 }
\ No newline at end of file
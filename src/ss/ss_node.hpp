@@ -6,9 +6,9 @@
 #include <vector>
 #include <sstream>
 #include <unordered_set>
+#include <cstdint>
 
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 #include <memory>
 
 #include "ss_data.hpp"
@@ -16,9 +16,22 @@
 #include "ss_node_types.hpp"
 #include "ss_pins.hpp"
 #include "ss_data.hpp"
+#include "ss_folding.hpp"
+#include "ss_code_writer.hpp"
+#include "ss_edge_table.hpp"
 #include "ga_cube_component.h"
+#include "ss_canvas_view.hpp"
+#include "ss_canvas_renderer.hpp"
 
 #define NODE_TEXTURE_NULL 0xFFFFFFFF
+// Size of the intermediate result textures, and the number of mips previews may be rendered at
+#define NODE_PREVIEW_SIZE 256
+#define NODE_PREVIEW_MIPS 5
+
+class Base_GraphNode;
+class SS_Node_Store;
+// Nodes of a graph with stale code or a stale intermediate program, see SS_Graph::GetDirtyNodes
+typedef std::unordered_set<Base_GraphNode*> SS_Dirty_Set;
 
 /**
  * Base class for all graph nodes, handles drawing and display management.
@@ -26,32 +39,103 @@
 class Base_GraphNode {
 public:
     virtual ~Base_GraphNode();
-    virtual void SetBounds(float scale);
-    virtual void Draw(ImDrawList* drawList, ImVec2 pos_offset, bool is_hover);
-    void DrawOutputConnects(ImDrawList* drawList, ImVec2 offset);
+    // Lay out the rect and pins in canvas units, only recomputed after InvalidateLayout or when the font size changes
+    virtual void SetBounds();
+    // The name, pins or pin types changed, lay the node out again on the next SetBounds
+    void InvalidateLayout() { m_isLayoutDirty = true; MarkLayoutChanged(); }
+    // Draw through the view, as a plain rect when it is zoomed out past the detail zoom.
+        // Text and images go to the draw list, every other shape to the canvas renderer
+    virtual void Draw(ImDrawList* drawList, SS_Canvas_Renderer& shapes, const SS_Canvas_View& view, bool is_hover);
+    // Add the wire of a connection, from the output pin to the input pin, straight when zoomed out
+    static void DrawConnection(SS_Canvas_Renderer& shapes, Base_OutputPin& o_pin, Base_InputPin& i_pin,
+                               const SS_Canvas_View& view);
     bool IsHovering(ImVec2 mouse_pos);
     Base_Pin* GetHoveredPin(ImVec2 mouse_pos);
 
     // Toggle intermediate display
-    void ToggleDisplay() { m_isDisplayUp = !m_isDisplayUp; };
+    void ToggleDisplay() { m_isDisplayUp = !m_isDisplayUp; MarkLayoutChanged(); };
     bool IsDisplayButtonHoveredOver(ImVec2 p);
 
-    virtual std::string RequestOutput(int out_index) = 0;
-    virtual std::string ProcessForCode() = 0;
-    void SetShaderCode(const std::string& frag_shad, const std::string& vert_shad);
-
-    unsigned int GetMostRestrictiveGentypeInSubgraph(Base_Pin* start_pin);
-    void PropagateGentypeInSubgraph(Base_Pin* start_pin, unsigned int type);
+    // Write the expression usable for the output, a variable or an inline expression
+    virtual void WriteOutput(int out_index, SS_Code_Writer& writer) = 0;
+    // Write the node's statements
+    virtual void ProcessForCode(SS_Code_Writer& code) = 0;
+
+    // Regenerate the cached code and output expressions, only if the node is code dirty.
+    // ASSUMES the caches of all input nodes are up-to-date (call in topological order)
+    void UpdateCodeCache();
+    SS_String_View GetCachedCode() const { return m_cachedText.View(0, m_cachedCodeEnd); }
+    SS_String_View GetCachedOutput(int out_index) const {
+        return m_cachedText.View(out_index == 0 ? m_cachedCodeEnd : m_cachedOutputEnds[out_index - 1], m_cachedOutputEnds[out_index]);
+    }
+    // Merkle hash of the node's definition and its inputs' hashes, refreshed with the code cache.
+    // Nodes with equal hashes compute the same values (up to collisions, verify before reusing)
+    uint64_t GetStructuralHash() const { return m_structuralHash; }
+    // Whether the outputs were evaluated while generating code, because every input is a constant
+    bool HasConstantOutputs() const { return not m_constantOutputs.empty(); }
+    const Folded_Value& GetConstantOutput(int out_index) const { return m_constantOutputs[out_index]; }
+    bool IsCodeDirty() const { return m_isCodeDirty; }
+
+    // GENTYPE CLASSES, generic pins connected through generic pins share one length, kept in a union-find forest.
+        // All the generic pins of a node are in the node's class
+    // Length mask of the node's class
+    unsigned int GetGentypeLength();
+    // Merge the classes of two nodes with connected generic pins
+    static void UniteGentypes(Base_GraphNode* a, Base_GraphNode* b);
+    // Restrict the class to a length, for a generic pin connected to a non-generic one
+    void RestrictGentype(unsigned int len);
+    // Rebuild the node's class from the remaining connections of its members, after a disconnect.
+        // Without updatePins, only the classes are rebuilt and the pins keep their lengths
+    void SplitGentype(bool updatePins);
+
+    // Mark the node and everything downstream as needing new code and a new intermediate program.
+        // Each node is visited once, however many paths lead to it
     void PropagateBuildDirty();
-
-    virtual NODE_TYPE GetNodeType() { return NODE_DEFAULT; };
+    static void PropagateBuildDirty(const std::vector<Base_GraphNode*>& nodes);
+    // Require a recompile of the intermediate program, without regenerating the node's code
+    void InvalidateIntermediateProgram() { m_isBuildDirty = true; m_isBuildSubmitted = false; UpdateDirtySet(); }
+    // The node is displayed by a program built elsewhere, i.e. the graph's single preview program.
+        // Submitted with the node's current code, then finished with whether it linked
+    void SubmitSharedIntermediateProgram() { m_isBuildSubmitted = true; }
+    void FinishSharedIntermediateProgram(bool linked);
+    // Keep the set holding the node for as long as it is dirty
+    void SetDirtySet(SS_Dirty_Set* dirtySet) { m_dirtySet = dirtySet; UpdateDirtySet(); }
+    // The connections of the node's graph, nullptr until the node is added to one
+    void SetEdgeTable(SS_Edge_Table* edgeTable) { m_edgeTable = edgeTable; }
+    SS_Edge_Table* GetEdgeTable() const { return m_edgeTable; }
+    // Free the node's own program, including one still building
+    void ReleaseIntermediateProgram() { m_cube.reset(); m_pendingCube.reset(); m_isBuildSubmitted = false; }
+    // Dirty until a program built from the node's current code has linked
+    bool IsBuildDirty() const { return m_isBuildDirty; }
+    // Dirty, and no program of the current code is building, i.e. a build has to submit one
+    bool NeedsIntermediateProgram() const { return m_isBuildDirty and not m_isBuildSubmitted; }
+
+    virtual NODE_TYPE GetNodeType() const { return NODE_DEFAULT; };
+
+    // Position in the topological order, greater than that of every node feeding the inputs.
+        // Kept as pins connect by PinOps::ConnectPins
+    int GetTopologicalIndex() const { return m_topoIndex; }
+    void SetTopologicalIndex(int index) { m_topoIndex = index; }
+    // Index after all others, valid for any node without input connections
+    static int NextTopologicalIndex() { return s_nextTopoIndex++; }
 
     virtual bool CanConnectPins(Base_InputPin* in_pin, Base_OutputPin* out_pin);
     virtual void InformOfConnect(Base_InputPin* in_pin, Base_OutputPin* out_pin) {}
 
+    // Create the textures the intermediate result renders to, done on the first draw so nodes can live without GL
     bool GenerateIntermediateResultFrameBuffers();
-    void CompileIntermediateCode(std::unique_ptr<ga_material>&& material);
-    void DrawIntermediateResult(unsigned int framebuffer, const std::vector<std::unique_ptr<Parameter_Data>>& params);
+    // Start building the intermediate program, the sources only need to outlive this call.
+        // The current program keeps drawing until the new one is ready
+    void CompileIntermediateCode(std::unique_ptr<ga_material>&& material,
+                                 const ga_shader_source& vert_source, const ga_shader_source& frag_source);
+    // Swap in the pending intermediate program once it linked, true once none is pending.
+        // A program that fails to link is dropped, the last good one keeps drawing and the node stays dirty
+    bool PollIntermediateProgram();
+    bool HasPendingIntermediateProgram() const { return m_pendingCube != nullptr; }
+    // Draw with the node's own program, or with a shared preview program which selects the node by u_preview_node.
+        // Renders into a mip of the preview texture, lower mips for previews drawn small, and displays that mip
+    void DrawIntermediateResult(unsigned int framebuffer, const std::vector<std::unique_ptr<Parameter_Data>>& params,
+                                ga_cube_component* preview = nullptr, int mip = 0);
 
     unsigned int GetImageTextureId() const { return m_nodesRenderedTexture; }
     virtual bool CanDrawIntermedImage() { return !m_outputPins[0].type.IsMatrix() && m_outputPins[0].type.arr_size == 1; ; };
@@ -66,88 +150,145 @@ public:
     int GetOutputPinCount() const { return (int)m_outputPins.size(); }
     const Base_InputPin& GetInputPin(int ind) const { return m_inputPins[ind]; }
     const Base_OutputPin& GetOutputPin(int ind) const {  return m_outputPins[ind]; }
+    Base_InputPin& GetInputPin(int ind) { return m_inputPins[ind]; }
+    Base_OutputPin& GetOutputPin(int ind) { return m_outputPins[ind]; }
 
     ImVec2 GetDrawPos() const { return m_pos; }
     ImVec2 GetDrawOldPos() const { return m_oldPos; }
     ImVec2 GetDrawRectSize() const { return m_rectSize; }
-    ImVec2 GetDrawInputPinRelativePos(int ind) const { return m_inPinRelPos[ind]; }
-    ImVec2 GetDrawOutputPinRelativePos(int ind) const { return m_outPinRelPos[ind]; }
-    ImVec2 GetDrawInputPinSize(int ind) const { return m_inPinSizes[ind]; }
-    ImVec2 GetDrawOutputPinSize(int ind) const { return m_outPinSizes[ind]; }
+    ImVec2 GetDrawInputPinRelativePos(int ind) const { return m_inputPins[ind].relPos; }
+    ImVec2 GetDrawOutputPinRelativePos(int ind) const { return m_outputPins[ind].relPos; }
 
     bool GetHasDisplayUp() const { return m_isDisplayUp; }
 
     int GetID() const { return m_id; }
-    const std::string& GetName() const { return m_name; }
+    SS_Name GetName() const { return m_name; }
 
     // SETTERS
-    void SetName(const std::string& newName) {
-        m_name = newName;
+    void SetName(SS_String_View newName) {
+        m_name = SS_Name(newName);
+        InvalidateLayout();
     }
     void SetDrawOldPos(ImVec2 pos) {
         m_oldPos = m_pos = pos;
+        MarkLayoutChanged();
     }
     void SetDrawPos(ImVec2 pos) {
         m_pos = pos;
+        MarkLayoutChanged();
     }
+    // The store holding the node, told whenever the node moves or its layout changes
+    void SetNodeStore(SS_Node_Store* store) { m_nodeStore = store; }
 
 protected:
-    unsigned int GetMostRestrictiveGentypeInSubgraph_Rec(Base_Pin* start_pin, std::unordered_set<int>& processed_ids);
-    void PropogateGentypeInSubgraph_Rec(Base_Pin* start_pin, unsigned int type, std::unordered_set<int>& processed_ids);
+    // Folds in what the node computes, ignoring its inputs and where it sits in the graph
+    virtual uint64_t HashDefinition(uint64_t hash) const;
+    uint64_t ComputeStructuralHash() const;
+    // Evaluate the outputs on the CPU, false when any of them is only known on the GPU.
+        // ASSUMES the caches of all input nodes are up-to-date
+    virtual bool EvaluateConstantOutputs(std::vector<Folded_Value>& outs) const { return false; }
+    // Collect the constant value of every input, unconnected inputs reading their default
+    bool GetConstantInputs(std::vector<Folded_Value>& ins) const;
+    // Shape one output value per output pin
+    bool MakeConstantOutputs(std::vector<Folded_Value>& outs) const;
+
+    // Have the store lay out and copy the node's layout on its next SyncChangedLayouts
+    void MarkLayoutChanged();
+    void UpdateDirtySet() {
+        if (not m_dirtySet) return;
+        if (m_isCodeDirty or m_isBuildDirty) m_dirtySet->insert(this);
+        else m_dirtySet->erase(this);
+    }
+
+    Base_GraphNode* FindGentypeRoot();
+    static Base_GraphNode* JoinGentypeRoots(Base_GraphNode* a, Base_GraphNode* b);
+    // Length allowed by the node's generic pins themselves
+    unsigned int GetOwnGentypeLength() const;
+    // Set the length of every generic pin in the node's class, marking the nodes that change as dirty
+    void ApplyGentypeLength(unsigned int len);
 
     int m_id;
+    int m_topoIndex = NextTopologicalIndex();
+    static int s_nextTopoIndex;
     ImVec2 m_oldPos;
     ImVec2 m_pos;
     std::unique_ptr<ga_cube_component> m_cube = nullptr;
+    std::unique_ptr<ga_cube_component> m_pendingCube = nullptr;
 
-    // BOUNDS
+    // BOUNDS, the pins hold their own positions
     ImVec2 m_rectSize;
-    std::vector<ImVec2> m_inPinSizes;
-    std::vector<ImVec2> m_outPinSizes;
-
-    // WARNING : FOR EASE OF USE, THESE ARE RELATIVE TO MOST UPPER LEFT POSITION OF NODE     
-    std::vector<ImVec2> m_inPinRelPos;
-    // WARNING : FOR EASE OF USE, THESE ARE RELATIVE TO MOST UPPER LEFT POSITION OF NODE
-    std::vector<ImVec2> m_outPinRelPos;
 
     unsigned int m_nodesRenderedTexture {NODE_TEXTURE_NULL };
     unsigned int m_nodesDepthTexture {NODE_TEXTURE_NULL };
-    std::string m_fragStr { }; // "#version 400\nvoid main() { gl_FragColor = vec4(0.5, 0.0, 1.0, 1.0); }"
-    std::string m_vertStr { }; // "#version 400\nlayout(location = 0) in vec3 in_vertex; void main() { gl_Position = vec4(in_vertex, 1.0); }"
+    // Mip of the rendered texture the last preview was drawn to and is displayed from
+    int m_previewMip = 0;
 
     ImVec2 m_displayPanelRelPos;
     ImVec2 m_displayPanelRelSize;
 
     ImVec2 m_nameRelSize;
+    // What the layout above was computed for
+    bool m_isLayoutDirty = true;
+    float m_layoutFontSize = 0;
 
-    std::string m_name;
+    SS_Name m_name;
     
     std::vector<Base_InputPin> m_inputPins;
     std::vector<Base_OutputPin> m_outputPins;
     int m_numInput, m_numOutput;
 
+    // CODE CACHE, only regenerated when the node is code dirty.
+        // The statements, then every output's expression back to back, split by the end offsets
+    SS_Code_Writer m_cachedText;
+    uint32_t m_cachedCodeEnd = 0;
+    std::vector<uint32_t> m_cachedOutputEnds;
+    uint64_t m_structuralHash = 0;
+    std::vector<Folded_Value> m_constantOutputs;
+
     bool m_isDisplayUp = false;
-    bool m_isBuildDirty = false;
+    // New nodes have neither code nor an intermediate program yet
+    bool m_isCodeDirty = true;
+    bool m_isBuildDirty = true;
+    // The pending program was built from the node's current code
+    bool m_isBuildSubmitted = false;
+    SS_Dirty_Set* m_dirtySet = nullptr;
+    SS_Edge_Table* m_edgeTable = nullptr;
+    SS_Node_Store* m_nodeStore = nullptr;
+
+    // GENTYPE CLASS
+    Base_GraphNode* m_gentypeParent = this;
+    // The members of a class form a ring
+    Base_GraphNode* m_gentypeNext = this;
+    unsigned int m_gentypeRank = 0;
+    // Length mask of the class, held by its root. 0 until first needed
+    unsigned int m_gentypeLen = 0;
+    // Epoch of the last propagation that reached the node
+    uint32_t m_dirtyEpoch = 0;
+    static uint32_t s_dirtyEpoch;
 };
 
 
 
 class Builtin_GraphNode : public Base_GraphNode {
 public:
-    Builtin_GraphNode(Builtin_Node_Data& data, int id, ImVec2 pos);
+    Builtin_GraphNode(const Builtin_Node_Data& data, int id, ImVec2 pos);
 
-    ~Builtin_GraphNode() override;
-    NODE_TYPE GetNodeType() override { return NODE_BUILTIN; };
+    NODE_TYPE GetNodeType() const override { return NODE_BUILTIN; };
     
-    std::string RequestOutput(int out_index) override;
-    std::string ProcessForCode() override;
+    void WriteOutput(int out_index, SS_Code_Writer& writer) override;
+    void ProcessForCode(SS_Code_Writer& code) override;
     bool CanDrawIntermedImage() override { return true; };
 
-    // Returns the string which is usable for the output specified
-        // could be a variable or a function, or a swizzling/new_vec
-    // ASSUMES PROCESS CODE CALLED FIRST
-    std::string _inliner;
-    std::vector<std::string> pin_parse_out_names;
+    // The shared definition the node was built from, see SS_Node_Factory::GetBuiltinNodeData
+    int GetDefinitionIndex() const { return m_definition; }
+    const Builtin_Node_Data& GetDefinition() const;
+
+protected:
+    uint64_t HashDefinition(uint64_t hash) const override;
+    bool EvaluateConstantOutputs(std::vector<Folded_Value>& outs) const override;
+
+    // Index of the definition, its inliner and pin names are never copied into the node
+    int m_definition;
 };
 
 class Constant_Node : public Base_GraphNode {
@@ -156,76 +297,87 @@ public:
     GRAPH_PARAM_TYPE _data_type;
     void* _data;
 
-    Constant_Node(Constant_Node_Data& data, int id, ImVec2 pos);
-    NODE_TYPE GetNodeType() override { return NODE_CONSTANT; };
+    Constant_Node(const Constant_Node_Data& data, int id, ImVec2 pos);
+    NODE_TYPE GetNodeType() const override { return NODE_CONSTANT; };
 
     bool CanDrawIntermedImage() override { return !m_outputPins[0].type.IsMatrix() && m_outputPins[0].type.arr_size == 1; };
 
-    std::string RequestOutput(int out_index) override;
-    std::string ProcessForCode() override;
+    void WriteOutput(int out_index, SS_Code_Writer& writer) override;
+    void ProcessForCode(SS_Code_Writer& code) override;
 
+protected:
+    uint64_t HashDefinition(uint64_t hash) const override;
+    bool EvaluateConstantOutputs(std::vector<Folded_Value>& outs) const override;
 };
 
 class Vector_Op_Node : public Base_GraphNode {
 public:
     VECTOR_OPS _vec_op;
 
-    Vector_Op_Node(Vector_Op_Node_Data& data, int id, ImVec2 pos);
+    Vector_Op_Node(const Vector_Op_Node_Data& data, int id, ImVec2 pos);
     void make_vec_break(int s);
     void make_vec_make(int s);
 
-     NODE_TYPE GetNodeType() override { return NODE_VECTOR_OP; };
+     NODE_TYPE GetNodeType() const override { return NODE_VECTOR_OP; };
 
     bool CanDrawIntermedImage() override { return false; };
 
-    std::string RequestOutput(int out_index) override;
-    std::string ProcessForCode() override;
+    void WriteOutput(int out_index, SS_Code_Writer& writer) override;
+    void ProcessForCode(SS_Code_Writer& code) override;
+
+protected:
+    uint64_t HashDefinition(uint64_t hash) const override;
+    bool EvaluateConstantOutputs(std::vector<Folded_Value>& outs) const override;
 };
 
 class Param_Node : public Base_GraphNode {
 public:
     int _paramID;
     Param_Node(Parameter_Data* data, int id, ImVec2 pos);
-    ~Param_Node() override;
 
-    NODE_TYPE GetNodeType() override { return NODE_PARAM; };
+    NODE_TYPE GetNodeType() const override { return NODE_PARAM; };
 
     bool CanDrawIntermedImage() override { return !m_outputPins[0].type.IsMatrix() && m_outputPins[0].type.arr_size == 1; ; };
 
 
-    std::string RequestOutput(int out_index) override;
-    std::string ProcessForCode() override;
+    void WriteOutput(int out_index, SS_Code_Writer& writer) override;
+    void ProcessForCode(SS_Code_Writer& code) override;
 
     void update_type_from_param(GLSL_TYPE type);
+
+protected:
+    uint64_t HashDefinition(uint64_t hash) const override;
 };
 
 struct Boilerplate_Var_Data;
 class Terminal_Node : public Base_GraphNode {
 public:
-    ~Terminal_Node() override;
     Terminal_Node(const std::vector<Boilerplate_Var_Data>& terminal_pins, int id, ImVec2 pos);
     bool CanDrawIntermedImage() override { return true; };
 
-    std::string RequestOutput(int out_index) override { return {}; }
-    std::string ProcessForCode() override { return {}; }
+    void WriteOutput(int out_index, SS_Code_Writer& writer) override {}
+    void ProcessForCode(SS_Code_Writer& code) override {}
 
     bool frag_node;
-     NODE_TYPE GetNodeType() override { return NODE_TERMINAL; };
+     NODE_TYPE GetNodeType() const override { return NODE_TERMINAL; };
+
+protected:
+    uint64_t HashDefinition(uint64_t hash) const override;
 };
 
 
 class SS_Boilerplate_Manager;
 class Boilerplate_Var_Node : public Base_GraphNode {
 public:
-    Boilerplate_Var_Node(Boilerplate_Var_Data data, SS_Boilerplate_Manager* bp, int id, ImVec2 pos);
+    Boilerplate_Var_Node(const Boilerplate_Var_Data& data, SS_Boilerplate_Manager* bp, int id, ImVec2 pos);
     bool CanDrawIntermedImage() override { return not m_outputPins[0].type.IsMatrix() && m_outputPins[0].type.arr_size == 1; };
 
 
     bool frag_node;
     SS_Boilerplate_Manager* _bpManager;
-    NODE_TYPE GetNodeType() override { return NODE_BOILER_VAR; };
+    NODE_TYPE GetNodeType() const override { return NODE_BOILER_VAR; };
     
-    std::string RequestOutput(int out_index) override;
-    std::string ProcessForCode() override;
+    void WriteOutput(int out_index, SS_Code_Writer& writer) override;
+    void ProcessForCode(SS_Code_Writer& code) override;
 };
 #endif
\ No newline at end of file
@@ -20,6 +20,18 @@ bool SS_Node_Factory::InitReadInBoilerplateParams(const std::vector<Boilerplate_
     return true;
 }
 
+// Indexed by gentype
+static const Constant_Node_Data constantNodeDatas[] = {
+    {"Scalar", SS_Scalar, SS_Float}, {"Vec2", SS_Vec2, SS_Float}, {"Vec3", SS_Vec3, SS_Float},
+    {"Vec4", SS_Vec4, SS_Float}, {"Mat2", SS_Mat2, SS_Float}, {"Mat3", SS_Mat3, SS_Float},
+    {"Mat4", SS_Mat4, SS_Float},
+};
+// Indexed by op
+static const Vector_Op_Node_Data vectorOpNodeDatas[] = {
+    {"break vec2", VEC_BREAK2_OP}, {"break vec3", VEC_BREAK3_OP}, {"break vec4", VEC_BREAK4_OP},
+    {"make vec2", VEC_MAKE2_OP}, {"make vec3", VEC_MAKE3_OP}, {"make vec4", VEC_MAKE4_OP},
+};
+
 bool SS_Node_Factory::bNodeDataInitialized = false;
 std::vector<Builtin_Node_Data> SS_Node_Factory::nodeDatas{};
 bool SS_Node_Factory::InitReadBuiltinFile(const std::string& file) {
@@ -33,18 +45,22 @@ bool SS_Node_Factory::InitReadBuiltinFile(const std::string& file) {
     while (iff >> token) {
         std::unordered_map<std::string, int> inputs_map; 
         nodeDatas.emplace_back();
-        nodeDatas.back().in_liner = "";
+        nodeDatas.back().index = (int)nodeDatas.size() - 1;
+        std::string in_liner;
+        Inliner_Template& tmpl = nodeDatas.back().in_liner_template;
 
         std::string str_type, str_name;
         if (token == "out") {
             iff >> str_type >> str_name;
             GLSL_TYPE t = SS_Parser::StringToGLSLType(str_type);
-            nodeDatas.back().out_vars.emplace_back(t, str_name);
+            nodeDatas.back().out_vars.emplace_back(t, SS_Name(str_name));
+            tmpl.assigns_first_output = true;
             iff >> token; // token is =
             iff >> token; // token should be non-var element
         }
         // At this point, token should be non-processed, non-var element
-        nodeDatas.back().in_liner += token;
+        in_liner += token;
+        tmpl.AppendLiteral(token);
 
         // handle variables
         while (iff >> token) {
@@ -53,50 +69,68 @@ bool SS_Node_Factory::InitReadBuiltinFile(const std::string& file) {
             size_t end_t = token.find(';');
             if (is_out) {
                 iff >> str_type >> str_name;
-                nodeDatas.back().out_vars.emplace_back(SS_Parser::StringToGLSLType(str_type), str_name);
-                nodeDatas.back().in_liner += "out \%o";
-                nodeDatas.back().in_liner += std::to_string(nodeDatas.back().out_vars.size()); // out var number
+                nodeDatas.back().out_vars.emplace_back(SS_Parser::StringToGLSLType(str_type), SS_Name(str_name));
+                in_liner += "out \%o";
+                in_liner += std::to_string(nodeDatas.back().out_vars.size()); // out var number
+                tmpl.AppendSlot(Inliner_Template::OUTPUT, nodeDatas.back().out_vars.size() - 1);
             } 
             else if (is_in) {
                 iff >> str_type >> str_name;
                 if (inputs_map.find(str_name) == inputs_map.end()) {
-                    nodeDatas.back().in_vars.emplace_back(SS_Parser::StringToGLSLType(str_type), str_name);
+                    nodeDatas.back().in_vars.emplace_back(SS_Parser::StringToGLSLType(str_type), SS_Name(str_name));
                     inputs_map.insert(std::make_pair(str_name, nodeDatas.back().in_vars.size()));
                 }
-                nodeDatas.back().in_liner += " \%i";
-                nodeDatas.back().in_liner += std::to_string(inputs_map[str_name]); // in var number
+                in_liner += " \%i";
+                in_liner += std::to_string(inputs_map[str_name]); // in var number
+                tmpl.AppendLiteral(" ");
+                tmpl.AppendSlot(Inliner_Template::INPUT, inputs_map[str_name] - 1);
             } 
             else if (end_t == std::string::npos) {
                 // NON_VAR
-                nodeDatas.back().in_liner += token;
+                in_liner += token;
+                tmpl.AppendLiteral(token);
             } 
             else /* CLOSE OUT FUNCTION */ {
                 // CLOSE OUT FUNCTION
-                nodeDatas.back().in_liner += token.substr(0, end_t);
-                iff >> nodeDatas.back()._name;
+                in_liner += token.substr(0, end_t);
+                tmpl.AppendLiteral(token.substr(0, end_t));
+                iff >> str_name;
+                nodeDatas.back()._name = SS_Name(str_name);
                 break;
             }
         }
+        nodeDatas.back().in_liner = SS_Name(in_liner);
     }
     bNodeDataInitialized = true;
     return true;
 }
 
 
-std::vector<Builtin_Node_Data> SS_Node_Factory::GetMatchingBuiltinNodes(const std::string& query) {
-    // empty, give all
-    if (query.empty()) {
-        return nodeDatas;
-    }
+const Builtin_Node_Data* SS_Node_Factory::GetBuiltinNodeData(int index) {
+    if (index < 0 || index >= (int)nodeDatas.size()) return nullptr;
+    return &nodeDatas[index];
+}
 
-    // collect all with shared substring
-    std::vector<Builtin_Node_Data> builtinDatas;
-    std::copy_if(nodeDatas.begin(), nodeDatas.end(),
-                 std::back_inserter(builtinDatas),
-                 [query](Builtin_Node_Data& nd) {return SS_Parser::StringToLower(nd._name).find(query) != std::string::npos; } );
+std::vector<const Builtin_Node_Data*> SS_Node_Factory::GetMatchingBuiltinNodes(const std::string& query) {
+    // collect all with shared substring, empty gives all
+    std::vector<const Builtin_Node_Data*> builtinDatas;
+    for (const Builtin_Node_Data& nd : nodeDatas) {
+        if (query.empty() || SS_Parser::StringToLower(nd._name.str()).find(query) != std::string::npos)
+            builtinDatas.push_back(&nd);
+    }
     return builtinDatas;
 }
 
+const Constant_Node_Data* SS_Node_Factory::GetConstantNodeData(unsigned int gentype) {
+    if (gentype >= sizeof(constantNodeDatas) / sizeof(constantNodeDatas[0])) return nullptr;
+    return &constantNodeDatas[gentype];
+}
+
+const Vector_Op_Node_Data* SS_Node_Factory::GetVectorOpNodeData(unsigned int op) {
+    if (op >= sizeof(vectorOpNodeDatas) / sizeof(vectorOpNodeDatas[0])) return nullptr;
+    return &vectorOpNodeDatas[op];
+}
+
 std::vector<Constant_Node_Data> SS_Node_Factory::GetMatchingConstantNodes(const std::string& query) {
     std::string queryLower = SS_Parser::StringToLower(query);
     bool all_valid = std::string("constant").find(queryLower) != std::string::npos;
@@ -111,19 +145,19 @@ std::vector<Constant_Node_Data> SS_Node_Factory::GetMatchingConstantNodes(const
 
     std::vector<Constant_Node_Data> constantDatas;
     if (all_valid || scalar.find(queryLower) != std::string::npos)
-        constantDatas.push_back(Constant_Node_Data{"Scalar", SS_Scalar, SS_Float});
+        constantDatas.push_back(constantNodeDatas[SS_Scalar]);
     if (all_valid || vec2.find(queryLower) != std::string::npos)
-        constantDatas.push_back(Constant_Node_Data{"Vec2", SS_Vec2, SS_Float});
+        constantDatas.push_back(constantNodeDatas[SS_Vec2]);
     if (all_valid || vec3.find(queryLower) != std::string::npos)
-        constantDatas.push_back(Constant_Node_Data{"Vec3", SS_Vec3, SS_Float});
+        constantDatas.push_back(constantNodeDatas[SS_Vec3]);
     if (all_valid || vec4.find(queryLower) != std::string::npos)
-        constantDatas.push_back(Constant_Node_Data{"Vec4", SS_Vec4, SS_Float});
+        constantDatas.push_back(constantNodeDatas[SS_Vec4]);
     if (all_valid || mat2.find(queryLower) != std::string::npos)
-        constantDatas.push_back(Constant_Node_Data{"Mat2", SS_Mat2, SS_Float});
+        constantDatas.push_back(constantNodeDatas[SS_Mat2]);
     if (all_valid || mat3.find(queryLower) != std::string::npos)
-        constantDatas.push_back(Constant_Node_Data{"Mat3", SS_Mat3, SS_Float});
+        constantDatas.push_back(constantNodeDatas[SS_Mat3]);
     if (all_valid || mat4.find(queryLower) != std::string::npos)
-        constantDatas.push_back(Constant_Node_Data{"Mat4", SS_Mat4, SS_Float});
+        constantDatas.push_back(constantNodeDatas[SS_Mat4]);
     return constantDatas;
 }
 
@@ -140,18 +174,18 @@ std::vector<Vector_Op_Node_Data> SS_Node_Factory::GetMatchingVectorNodes(const s
 
     std::vector<Vector_Op_Node_Data> opDatas;
     if (all_valid || br_vec2.find(queryLower) != std::string::npos)
-        opDatas.push_back(Vector_Op_Node_Data{"break vec2", VEC_BREAK2_OP});
+        opDatas.push_back(vectorOpNodeDatas[VEC_BREAK2_OP]);
     if (all_valid || br_vec3.find(queryLower) != std::string::npos)
-        opDatas.push_back(Vector_Op_Node_Data{"break vec3", VEC_BREAK3_OP});
+        opDatas.push_back(vectorOpNodeDatas[VEC_BREAK3_OP]);
     if (all_valid || br_vec4.find(queryLower) != std::string::npos)
-        opDatas.push_back(Vector_Op_Node_Data{"break vec4", VEC_BREAK4_OP});
+        opDatas.push_back(vectorOpNodeDatas[VEC_BREAK4_OP]);
     
     if (all_valid || mk_vec2.find(queryLower) != std::string::npos)
-        opDatas.push_back(Vector_Op_Node_Data{"make vec2", VEC_MAKE2_OP});
+        opDatas.push_back(vectorOpNodeDatas[VEC_MAKE2_OP]);
     if (all_valid || mk_vec3.find(queryLower) != std::string::npos)
-        opDatas.push_back(Vector_Op_Node_Data{"make vec3", VEC_MAKE3_OP});
+        opDatas.push_back(vectorOpNodeDatas[VEC_MAKE3_OP]);
     if (all_valid || mk_vec4.find(queryLower) != std::string::npos)
-        opDatas.push_back(Vector_Op_Node_Data{"make vec4", VEC_MAKE4_OP});
+        opDatas.push_back(vectorOpNodeDatas[VEC_MAKE4_OP]);
     return opDatas;
 }
 
@@ -198,41 +232,32 @@ std::vector<Boilerplate_Var_Data> SS_Node_Factory::GetMatchingBoilerplateNodes(c
 
 
 
-Builtin_GraphNode* SS_Node_Factory::BuildBuiltinNode(Builtin_Node_Data& node_data, int id, ImVec2 pos) {
+Builtin_GraphNode* SS_Node_Factory::BuildBuiltinNode(const Builtin_Node_Data& node_data, int id, ImVec2 pos) {
     auto* n = new Builtin_GraphNode(node_data, id, pos);
-    n->GenerateIntermediateResultFrameBuffers();
-    // std::vector<Parameter_Data*> nil;
-    // n->CompileIntermediateCode(fb, nil);
     return n;
 }
 
-Constant_Node* SS_Node_Factory::BuildConstantNode(Constant_Node_Data& node_data, int id, ImVec2 pos) {
+Constant_Node* SS_Node_Factory::BuildConstantNode(const Constant_Node_Data& node_data, int id, ImVec2 pos) {
     auto* n = new Constant_Node(node_data, id, pos);
-    n->GenerateIntermediateResultFrameBuffers();
-    // std::vector<Parameter_Data*> nil;
-    // n->CompileIntermediateCode(fb, nil);
     return n;
 }
 
-Vector_Op_Node* SS_Node_Factory::BuildVecOpNode(Vector_Op_Node_Data& node_data, int id, ImVec2 pos) {
+Vector_Op_Node* SS_Node_Factory::BuildVecOpNode(const Vector_Op_Node_Data& node_data, int id, ImVec2 pos) {
     auto* n = new Vector_Op_Node(node_data, id, pos);
     return n;
 }
 
 Param_Node* SS_Node_Factory::BuildParamNode(Parameter_Data* param_data, int id, ImVec2 pos) {
     auto* n = new Param_Node(param_data, id, pos);
-    n->GenerateIntermediateResultFrameBuffers();
     return n;
 }
 
-Boilerplate_Var_Node* SS_Node_Factory::BuildBoilerplateVarNode(Boilerplate_Var_Data& data, SS_Boilerplate_Manager* bm, int id, ImVec2 pos) {
+Boilerplate_Var_Node* SS_Node_Factory::BuildBoilerplateVarNode(const Boilerplate_Var_Data& data, SS_Boilerplate_Manager* bm, int id, ImVec2 pos) {
     auto* n = new Boilerplate_Var_Node(data, bm, id, pos);
-    n->GenerateIntermediateResultFrameBuffers();
     return n;
 }
 
 Terminal_Node * SS_Node_Factory::BuildTerminalNode(const std::vector<Boilerplate_Var_Data> &varData, int id, ImVec2 pos) {
     auto* tn = new Terminal_Node(varData, id, pos);
-    tn->GenerateIntermediateResultFrameBuffers();
     return tn;
 }
@@ -18,9 +18,16 @@ public:
 
     static bool InitReadBuiltinFile(const std::string& file);
     static bool InitReadInBoilerplateParams(const std::vector<Boilerplate_Var_Data>& varData);
+    static bool IsInitialized() { return bNodeDataInitialized and bBoilerplateInitialized; }
+
+    // Builtins by their line in the builtin file, names alone are shared by overloads. nullptr if not found
+    static const Builtin_Node_Data* GetBuiltinNodeData(int index);
+    // Constants by gentype and vector ops by op, as files store them. nullptr if out of range
+    static const Constant_Node_Data* GetConstantNodeData(unsigned int gentype);
+    static const Vector_Op_Node_Data* GetVectorOpNodeData(unsigned int op);
 
     // Search functions, caches and returns search results
-    static std::vector<Builtin_Node_Data> GetMatchingBuiltinNodes(const std::string& query);
+    static std::vector<const Builtin_Node_Data*> GetMatchingBuiltinNodes(const std::string& query);
     static std::vector<Constant_Node_Data> GetMatchingConstantNodes(const std::string& query);
     static std::vector<Vector_Op_Node_Data> GetMatchingVectorNodes(const std::string& query);
     static std::vector<Parameter_Data*> GetMatchingParamNodes(std::string query, const std::vector<Parameter_Data*>& data_in);
@@ -28,11 +35,11 @@ public:
     static std::vector<Boilerplate_Var_Data> GetMatchingBoilerplateNodes(const std::string& query);
 
     // Build and return dynamically allocated m_nodes
-    static class Builtin_GraphNode* BuildBuiltinNode(Builtin_Node_Data& node_data, int id, ImVec2 pos);
-    static class Constant_Node* BuildConstantNode(Constant_Node_Data& node_data, int id, ImVec2 pos);
-    static class Vector_Op_Node* BuildVecOpNode(Vector_Op_Node_Data& node_data, int id, ImVec2 pos);
+    static class Builtin_GraphNode* BuildBuiltinNode(const Builtin_Node_Data& node_data, int id, ImVec2 pos);
+    static class Constant_Node* BuildConstantNode(const Constant_Node_Data& node_data, int id, ImVec2 pos);
+    static class Vector_Op_Node* BuildVecOpNode(const Vector_Op_Node_Data& node_data, int id, ImVec2 pos);
     static class Param_Node* BuildParamNode(Parameter_Data* param_data, int id, ImVec2 pos);
-    static class Boilerplate_Var_Node* BuildBoilerplateVarNode(Boilerplate_Var_Data& data, class SS_Boilerplate_Manager* bm, int id, ImVec2 pos);
+    static class Boilerplate_Var_Node* BuildBoilerplateVarNode(const Boilerplate_Var_Data& data, class SS_Boilerplate_Manager* bm, int id, ImVec2 pos);
 
     static class Terminal_Node* BuildTerminalNode(const std::vector<Boilerplate_Var_Data> &varData, int i, ImVec2 pos);
 protected:
@@ -0,0 +1,257 @@
+#include "ss_node_store.hpp"
+#include "ss_node.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+int SS_Node_Store::NextFreeID() {
+    // IDs taken since they were freed are dropped here rather than searched for on insert
+    while (not m_freeIDs.empty() && not IsFreeID(m_freeIDs.back()))
+        m_freeIDs.pop_back();
+    return m_freeIDs.empty() ? (int)m_slots.size() : m_freeIDs.back();
+}
+
+void SS_Node_Store::Insert(int id, Base_GraphNode* node) {
+    assert(IsFreeID(id) && node);
+    // IDs skipped over are handed out later
+    for (int skipped = (int)m_slots.size(); skipped < id; ++skipped)
+        m_freeIDs.push_back(skipped);
+    if (id >= (int)m_slots.size())
+        m_slots.resize(id + 1);
+
+    m_slots[id].dense = (int)m_dense.size();
+    m_dense.emplace_back(node);
+    m_denseIDs.push_back(id);
+    m_positions.push_back(ImVec2(0, 0));
+    m_rectSizes.push_back(ImVec2(0, 0));
+    m_flags.push_back(0);
+    m_cellRanges.push_back(Cell_Range());
+    m_visitStamps.push_back(0);
+    node->SetNodeStore(this);
+    SyncLayout(m_dense.size() - 1);
+    // Laid out on the next sync
+    MarkLayoutChanged(id);
+}
+
+bool SS_Node_Store::Erase(int id) {
+    if (not Contains(id)) return false;
+    size_t dense = (size_t)m_slots[id].dense;
+    RemoveFromCells(id, m_cellRanges[dense]);
+    // The last node moves into the erased place
+    size_t last = m_dense.size() - 1;
+    if (dense != last) {
+        std::swap(m_dense[dense], m_dense[last]);
+        m_denseIDs[dense] = m_denseIDs[last];
+        m_positions[dense] = m_positions[last];
+        m_rectSizes[dense] = m_rectSizes[last];
+        m_flags[dense] = m_flags[last];
+        m_cellRanges[dense] = m_cellRanges[last];
+        m_visitStamps[dense] = m_visitStamps[last];
+        m_slots[m_denseIDs[dense]].dense = (int)dense;
+    }
+    m_slots[id].dense = -1;
+    ++m_slots[id].generation;
+    m_freeIDs.push_back(id);
+
+    // Destroyed once the store is consistent again
+    std::unique_ptr<Base_GraphNode> erased = std::move(m_dense.back());
+    m_dense.pop_back();
+    m_denseIDs.pop_back();
+    m_positions.pop_back();
+    m_rectSizes.pop_back();
+    m_flags.pop_back();
+    m_cellRanges.pop_back();
+    m_visitStamps.pop_back();
+    return true;
+}
+
+Base_GraphNode* SS_Node_Store::Find(int id) const {
+    if (id <= 0 || id >= (int)m_slots.size() || m_slots[id].dense < 0) return nullptr;
+    return m_dense[m_slots[id].dense].get();
+}
+
+Base_GraphNode* SS_Node_Store::Find(SS_Node_Handle handle) const {
+    Base_GraphNode* node = Find(handle.id);
+    return node && m_slots[handle.id].generation == handle.generation ? node : nullptr;
+}
+
+SS_Node_Handle SS_Node_Store::GetHandle(int id) const {
+    SS_Node_Handle handle;
+    if (not Contains(id)) return handle;
+    handle.id = id;
+    handle.generation = m_slots[id].generation;
+    return handle;
+}
+
+void SS_Node_Store::Reserve(size_t count) {
+    m_dense.reserve(count);
+    m_denseIDs.reserve(count);
+    m_positions.reserve(count);
+    m_rectSizes.reserve(count);
+    m_flags.reserve(count);
+    m_cellRanges.reserve(count);
+    m_visitStamps.reserve(count);
+}
+
+void SS_Node_Store::MarkLayoutChanged(int id) {
+    assert(Contains(id));
+    auto dense = (size_t)m_slots[id].dense;
+    if (m_flags[dense] & k_layoutChanged) return;
+    m_flags[dense] |= k_layoutChanged;
+    m_changedLayouts.push_back(id);
+}
+
+void SS_Node_Store::SyncChangedLayouts() {
+    for (int id : m_changedLayouts) {
+        if (not Contains(id)) continue;
+        auto dense = (size_t)m_slots[id].dense;
+        m_dense[dense]->SetBounds();
+        SyncLayout(dense);
+    }
+    m_changedLayouts.clear();
+}
+
+void SS_Node_Store::SyncLayout(size_t dense) {
+    const Base_GraphNode* node = m_dense[dense].get();
+    m_positions[dense] = node->GetDrawPos();
+    m_rectSizes[dense] = node->GetDrawRectSize();
+    m_flags[dense] = node->GetHasDisplayUp() ? k_displayUp : 0;
+
+    // Most frames nothing moves far enough to change cells
+    ImVec2 min, max;
+    GetDenseBounds(dense, min, max);
+    Cell_Range range = GetCellRange(min, max);
+    if (range == m_cellRanges[dense]) return;
+    RemoveFromCells(m_denseIDs[dense], m_cellRanges[dense]);
+    AddToCells(m_denseIDs[dense], range);
+    m_cellRanges[dense] = range;
+}
+
+int SS_Node_Store::FindHovered(ImVec2 pos) const {
+    Cell_Range range = GetCellRange(pos, pos);
+    auto it = m_cells.find(GetCellKey(range.x0, range.y0));
+    if (it == m_cells.end()) return -1;
+    // Topmost is drawn last, the largest dense index
+    int hovered = -1;
+    for (int id : it->second) {
+        auto dense = (size_t)m_slots[id].dense;
+        if (Hits(dense, pos) && (hovered < 0 || (int)dense > m_slots[hovered].dense)) hovered = id;
+    }
+    return hovered;
+}
+
+void SS_Node_Store::FindVisible(ImVec2 min, ImVec2 max, std::vector<size_t>& visible) {
+    visible.clear();
+    auto overlaps = [&](size_t dense) {
+        ImVec2 n_min, n_max;
+        GetDenseBounds(dense, n_min, n_max);
+        return n_max.x >= min.x && n_min.x <= max.x && n_max.y >= min.y && n_min.y <= max.y;
+    };
+    Cell_Range range = GetCellRange(min, max);
+    // Zoomed far out, scanning the nodes beats visiting mostly empty cells
+    if ((double)(range.x1 - range.x0 + 1) * (range.y1 - range.y0 + 1) > (double)m_dense.size()) {
+        for (size_t n = 0; n < m_dense.size(); ++n) {
+            if (overlaps(n)) visible.push_back(n);
+        }
+        return;
+    }
+
+    // A node is in every cell it overlaps, the stamps keep it from being found twice
+    if (++m_visitStamp == 0) {
+        std::fill(m_visitStamps.begin(), m_visitStamps.end(), 0);
+        m_visitStamp = 1;
+    }
+    for (int y = range.y0; y <= range.y1; ++y) {
+        for (int x = range.x0; x <= range.x1; ++x) {
+            auto it = m_cells.find(GetCellKey(x, y));
+            if (it == m_cells.end()) continue;
+            for (int id : it->second) {
+                auto dense = (size_t)m_slots[id].dense;
+                if (m_visitStamps[dense] == m_visitStamp) continue;
+                m_visitStamps[dense] = m_visitStamp;
+                if (overlaps(dense)) visible.push_back(dense);
+            }
+        }
+    }
+    std::sort(visible.begin(), visible.end());
+}
+
+void SS_Node_Store::SplitOverlapping(std::vector<size_t>& visible, std::vector<size_t>& overlapping) {
+    overlapping.clear();
+    if (++m_visitStamp == 0) {
+        std::fill(m_visitStamps.begin(), m_visitStamps.end(), 0);
+        m_visitStamp = 1;
+    }
+    // Sweep along x, a node can only overlap the nodes starting before its right edge
+    auto left = [&](size_t dense) { return m_positions[dense].x - m_rectSizes[dense].x * .5f; };
+    m_sweep.assign(visible.begin(), visible.end());
+    std::sort(m_sweep.begin(), m_sweep.end(), [&](size_t a, size_t b) { return left(a) < left(b); });
+    for (size_t i = 0; i < m_sweep.size(); ++i) {
+        ImVec2 a_min, a_max;
+        GetDenseBounds(m_sweep[i], a_min, a_max);
+        for (size_t j = i + 1; j < m_sweep.size(); ++j) {
+            ImVec2 b_min, b_max;
+            GetDenseBounds(m_sweep[j], b_min, b_max);
+            if (b_min.x > a_max.x) break;
+            if (b_max.y < a_min.y || b_min.y > a_max.y) continue;
+            m_visitStamps[m_sweep[i]] = m_visitStamp;
+            m_visitStamps[m_sweep[j]] = m_visitStamp;
+        }
+    }
+    size_t kept = 0;
+    for (size_t dense : visible) {
+        if (m_visitStamps[dense] == m_visitStamp) overlapping.push_back(dense);
+        else visible[kept++] = dense;
+    }
+    visible.resize(kept);
+}
+
+void SS_Node_Store::GetBounds(int id, ImVec2& min, ImVec2& max) const {
+    assert(Contains(id));
+    GetDenseBounds((size_t)m_slots[id].dense, min, max);
+}
+
+void SS_Node_Store::GetDenseBounds(size_t dense, ImVec2& min, ImVec2& max) const {
+    // Same bounds as Base_GraphNode::IsHovering, an open display panel hangs below the node
+    ImVec2 half(m_rectSizes[dense].x * .5f, m_rectSizes[dense].y * .5f);
+    min = ImVec2(m_positions[dense].x - half.x, m_positions[dense].y - half.y);
+    max = ImVec2(m_positions[dense].x + half.x, m_positions[dense].y + half.y);
+    if (m_flags[dense] & k_displayUp) max.y += m_rectSizes[dense].x;
+}
+
+bool SS_Node_Store::Hits(size_t dense, ImVec2 pos) const {
+    ImVec2 min, max;
+    GetDenseBounds(dense, min, max);
+    return pos.x > min.x && pos.y > min.y && pos.x < max.x && pos.y < max.y;
+}
+
+SS_Node_Store::Cell_Range SS_Node_Store::GetCellRange(ImVec2 min, ImVec2 max) const {
+    Cell_Range range;
+    range.x0 = (int)std::floor(min.x / k_cellSize);
+    range.y0 = (int)std::floor(min.y / k_cellSize);
+    range.x1 = (int)std::floor(max.x / k_cellSize);
+    range.y1 = (int)std::floor(max.y / k_cellSize);
+    return range;
+}
+
+void SS_Node_Store::AddToCells(int id, const Cell_Range& range) {
+    for (int y = range.y0; y <= range.y1; ++y) {
+        for (int x = range.x0; x <= range.x1; ++x)
+            m_cells[GetCellKey(x, y)].push_back(id);
+    }
+}
+
+void SS_Node_Store::RemoveFromCells(int id, const Cell_Range& range) {
+    for (int y = range.y0; y <= range.y1; ++y) {
+        for (int x = range.x0; x <= range.x1; ++x) {
+            auto it = m_cells.find(GetCellKey(x, y));
+            assert(it != m_cells.end());
+            std::vector<int>& ids = it->second;
+            auto found = std::find(ids.begin(), ids.end(), id);
+            assert(found != ids.end());
+            *found = ids.back();
+            ids.pop_back();
+            if (ids.empty()) m_cells.erase(it);
+        }
+    }
+}
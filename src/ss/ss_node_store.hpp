@@ -0,0 +1,131 @@
+#ifndef SS_NODE_STORE
+#define SS_NODE_STORE
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "../imgui/imgui.h"
+
+class Base_GraphNode;
+
+// Reference to a node which can be checked after the node is deleted, even once its ID is reused
+struct SS_Node_Handle {
+    int id = -1;
+    uint32_t generation = 0;
+
+    bool operator==(const SS_Node_Handle& other) const { return id == other.id && generation == other.generation; }
+    bool operator!=(const SS_Node_Handle& other) const { return not (*this == other); }
+};
+
+/**
+ * Generational slot map owning a graph's nodes, by ID.
+ * The nodes are packed densely, so walking every node each frame is a linear scan rather than a hash map walk.
+ * The layout read by the per-frame scans (position, rect size, display flag) is kept in arrays of its own, so those
+ * scans never touch the nodes themselves. The arrays are only written when a node changes: a node marks itself as it
+ * moves, toggles its display or needs a new layout, and SyncChangedLayouts lays out and copies just those nodes.
+ * The node bounds are also kept in a uniform grid of the canvas, so hovering and culling only look at the nodes
+ * near the point or view.
+ * WARNING: dense indices change as nodes are erased, keep IDs or handles instead.
+ */
+class SS_Node_Store {
+public:
+    // Largest ID a node may have, larger saved IDs are renumbered
+    static const int k_maxID = 1 << 20;
+
+    SS_Node_Store() = default;
+    SS_Node_Store(const SS_Node_Store&) = delete;
+    SS_Node_Store& operator=(const SS_Node_Store&) = delete;
+
+    // ID for the next node inserted, reusing the IDs of erased nodes first
+    int NextFreeID();
+    // Whether a node could be inserted with the ID
+    bool IsFreeID(int id) const { return id > 0 && id <= k_maxID && (id >= (int)m_slots.size() || m_slots[id].dense < 0); }
+    // Take ownership of a node under a free ID
+    void Insert(int id, Base_GraphNode* node);
+    // Destroy the node with the ID, false if there is none
+    bool Erase(int id);
+
+    Base_GraphNode* Find(int id) const;
+    Base_GraphNode* Find(SS_Node_Handle handle) const;
+    bool Contains(int id) const { return Find(id) != nullptr; }
+    SS_Node_Handle GetHandle(int id) const;
+    // One past the largest ID a node has had
+    int GetIDCapacity() const { return (int)m_slots.size(); }
+
+    // DENSE ACCESS, in insertion order apart from the nodes moved into erased places
+    size_t Size() const { return m_dense.size(); }
+    bool Empty() const { return m_dense.empty(); }
+    void Reserve(size_t count);
+    Base_GraphNode* At(size_t dense) const { return m_dense[dense].get(); }
+    std::vector<std::unique_ptr<Base_GraphNode>>::const_iterator begin() const { return m_dense.begin(); }
+    std::vector<std::unique_ptr<Base_GraphNode>>::const_iterator end() const { return m_dense.end(); }
+
+    // PER-FRAME LAYOUT
+    // Queue the layout of the node with the ID for the next SyncChangedLayouts, once however often it changes
+    void MarkLayoutChanged(int id);
+    // Set the bounds of the nodes marked since the last call and copy their layout, moving them in the grid if needed.
+        // Lays out text, so it needs the ImGui frame
+    void SyncChangedLayouts();
+    // ID of the topmost node under the point, drawn last, -1 if none
+    int FindHovered(ImVec2 pos) const;
+    // Dense indices of the nodes overlapping the rect, in drawing order
+    void FindVisible(ImVec2 min, ImVec2 max, std::vector<size_t>& visible);
+    // Move the nodes of visible which overlap another of them into overlapping, both lists keep drawing order
+    void SplitOverlapping(std::vector<size_t>& visible, std::vector<size_t>& overlapping);
+    // Bounds of the node with the ID, including an open display panel
+    void GetBounds(int id, ImVec2& min, ImVec2& max) const;
+    bool HasDisplayUp(size_t dense) const { return m_flags[dense] & k_displayUp; }
+
+private:
+    struct Slot {
+        int dense = -1;
+        uint32_t generation = 0;
+    };
+    // Cells covered by a node's bounds, inclusive, empty before the node's first sync
+    struct Cell_Range {
+        int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+
+        bool operator==(const Cell_Range& other) const {
+            return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1;
+        }
+    };
+    static const uint8_t k_displayUp = 1;
+    static const uint8_t k_layoutChanged = 2;
+    // Canvas units per grid cell, about the size of a node
+    static constexpr float k_cellSize = 256.f;
+
+    // Copy the layout of the node at a dense index, after its bounds are set
+    void SyncLayout(size_t dense);
+    void GetDenseBounds(size_t dense, ImVec2& min, ImVec2& max) const;
+    bool Hits(size_t dense, ImVec2 pos) const;
+    Cell_Range GetCellRange(ImVec2 min, ImVec2 max) const;
+    static uint64_t GetCellKey(int x, int y) { return (uint64_t)(uint32_t)x << 32 | (uint32_t)y; }
+    void AddToCells(int id, const Cell_Range& range);
+    void RemoveFromCells(int id, const Cell_Range& range);
+
+    // By ID, slot 0 is never used
+    std::vector<Slot> m_slots = std::vector<Slot>(1);
+    // IDs without a node, stale entries are skipped when popped
+    std::vector<int> m_freeIDs;
+
+    std::vector<std::unique_ptr<Base_GraphNode>> m_dense;
+    std::vector<int> m_denseIDs;
+    std::vector<ImVec2> m_positions;
+    std::vector<ImVec2> m_rectSizes;
+    std::vector<uint8_t> m_flags;
+    std::vector<Cell_Range> m_cellRanges;
+    // IDs marked by MarkLayoutChanged, including those of nodes erased since
+    std::vector<int> m_changedLayouts;
+
+    // GRID, IDs of the nodes overlapping each cell, by cell key
+    std::unordered_map<uint64_t, std::vector<int>> m_cells;
+    // Stamps marking the nodes already found by a query, by dense index
+    std::vector<uint32_t> m_visitStamps;
+    uint32_t m_visitStamp = 0;
+    // Dense indices sorted by their left edge, for SplitOverlapping
+    std::vector<size_t> m_sweep;
+};
+
+#endif
@@ -32,50 +32,57 @@ char GetBaseTypeToChar(GLSL_TYPE_ENUM_BITS type) {
     return '?';
 }
 
-std::string SS_Parser::GLSLTypeToString(GLSL_TYPE type) {
+namespace {
+    // Scratch writer for the std::string conversions, which are only used outside of codegen
+    SS_Code_Writer& GetScratchWriter() {
+        static SS_Code_Writer writer;
+        writer.Clear();
+        return writer;
+    }
+}
+
+void SS_Parser::WriteGLSLType(SS_Code_Writer& writer, GLSL_TYPE type) {
     GLSL_TYPE_ENUM_BITS type_flags = type.type_flags;
     if ((type_flags & GLSL_LenMask) == GLSL_LenMask && !(type_flags & GLSL_Mat)) {
         // GenType
         char vec_type = GetBaseTypeToChar(type_flags);
         if (vec_type == ' ')
-            return "GenType";
+            writer << "GenType";
         else
-            return std::string("Gen") + (char)toupper(vec_type) + "Type";
+            writer << "Gen" << (char)toupper(vec_type) << "Type";
+        return;
     } if ((type_flags & GLSL_LenMask) != GLSL_Scalar && !(type_flags & GLSL_Mat)) {
         // VECTOR
-        char vec_len = GetVecLenChar(type_flags);
-        char vec_type = GetBaseTypeToChar(type_flags);
-        std::string vec_str = "vec";
-        return vec_type + vec_str + vec_len;
+        writer << GetBaseTypeToChar(type_flags) << "vec" << GetVecLenChar(type_flags);
+        return;
     } else if (type_flags & GLSL_Mat && (type_flags & (GLSL_Bool | GLSL_Float | GLSL_Double | GLSL_Int))) {
         // MATRIX
-        return std::string("mat") + GetVecLenChar(type_flags);
+        writer << "mat" << GetVecLenChar(type_flags);
+        return;
     }
     if (type_flags & GLSL_TextureSampler2D) {
-        return "sampler2D";
-    }
-    if (type_flags & GLSL_TextureSampler3D) {
-        return "sampler3D";
-    } 
-    if (type_flags & GLSL_TextureSamplerCube) {
-        return "samplerCube";
-    }
-    if (type_flags & GLSL_Float) {
-        return "float";
-    }
-    if (type_flags & GLSL_UInt) {
-        return "uint";
-    }
-    if (type_flags & GLSL_Int) {
-        return "int";
+        writer << "sampler2D";
+    } else if (type_flags & GLSL_TextureSampler3D) {
+        writer << "sampler3D";
+    } else if (type_flags & GLSL_TextureSamplerCube) {
+        writer << "samplerCube";
+    } else if (type_flags & GLSL_Float) {
+        writer << "float";
+    } else if (type_flags & GLSL_UInt) {
+        writer << "uint";
+    } else if (type_flags & GLSL_Int) {
+        writer << "int";
+    } else if (type_flags & GLSL_Bool) {
+        writer << "bool";
+    } else if (type_flags & GLSL_Double) {
+        writer << "double";
     }
-    if (type_flags & GLSL_Bool) {
-        return "bool";
-    }
-    if (type_flags & GLSL_Double) {
-        return "double";
-    }
-    return "";
+}
+
+SS_Name SS_Parser::GetGLSLTypeName(GLSL_TYPE type) {
+    SS_Code_Writer& writer = GetScratchWriter();
+    WriteGLSLType(writer, type);
+    return SS_Name(writer.View());
 }
 
 
@@ -175,8 +182,8 @@ GLSL_TYPE SS_Parser::StringToGLSLType(std::string type_str) {
     }
     return type;
 }
-std::string SS_Parser::GetUniqueVarName(int node_id, int var_id, GLSL_TYPE type) {
-    return std::string("INTERNAL_VAR_") + std::to_string(node_id) + std::string("_") + std::to_string(var_id);
+void SS_Parser::WriteUniqueVarName(SS_Code_Writer& writer, int node_id, int var_id) {
+    writer << "INTERNAL_VAR_" << node_id << '_' << var_id;
 }
 
 ImU32 SS_Parser::GLSLTypeToColor(GLSL_TYPE type) {
@@ -220,95 +227,97 @@ GLSL_TYPE SS_Parser::ConstantTypeToGLSLType(GRAPH_PARAM_GENTYPE gentype, GRAPH_P
     return t;
 }
 
-std::string make_default_mat_str_val(char l) {
-    std::string mat_str = "mat";
-    mat_str += l;
-    mat_str += '(';
+void write_default_mat_val(SS_Code_Writer& writer, char l) {
     assert(l >= '2' && l <= '4');
+    writer << "mat" << l << '(';
     int size = l - '0';
     for (int e = 0; e < size*size; ++e) {
         int y = e / size;
         int x = e % size;
-        mat_str += y == x ? "1" : "0";
-        mat_str += e + 1 == size*size ? ", " : ");";
+        writer << (y == x ? '1' : '0');
+        writer << (e + 1 == size*size ? ")" : ", ");
     }
-    return mat_str;
 }
 
-std::string make_default_vec_str_val(char vec_len, char vec_type) {
-    return vec_type + std::string("vec") + vec_len + "()";
+void write_default_vec_val(SS_Code_Writer& writer, char vec_len, char vec_type) {
+    // GLSL has no empty vector constructor, fill every component with 1 like the scalar default
+    if (vec_type != ' ') writer << vec_type;
+    writer << "vec" << vec_len << "(1)";
 }
 
-std::string SS_Parser::GLSLTypeToDefaultValue(GLSL_TYPE type) {
+void SS_Parser::WriteDefaultValue(SS_Code_Writer& writer, GLSL_TYPE type) {
     GLSL_TYPE_ENUM_BITS type_flags = type.type_flags;
-    if ((type_flags & GLSL_LenMask) == GLSL_LenMask && !(type_flags & GLSL_Mat)) {
-        return "FAILURE";
-    } if ((type_flags & GLSL_LenMask) != GLSL_Scalar && !(type_flags & GLSL_Mat)) {
+    bool is_matrix = (type_flags & GLSL_Mat) && (type_flags & (GLSL_Float | GLSL_Double));
+    if ((type_flags & GLSL_LenMask) == GLSL_LenMask && !is_matrix) {
+        writer << "FAILURE";
+    } else if ((type_flags & GLSL_LenMask) != GLSL_Scalar && !is_matrix) {
         // VECTOR
-        char vec_len = GetVecLenChar(type_flags);
-        char vec_type = GetBaseTypeToChar(type_flags);
-        return make_default_vec_str_val(vec_len, vec_type);
-    } else if (type_flags & GLSL_Mat) {
+        write_default_vec_val(writer, GetVecLenChar(type_flags), GetBaseTypeToChar(type_flags));
+    } else if (is_matrix) {
         // MATRIX
-        return make_default_mat_str_val(GetVecLenChar(type_flags));
-    }
-    if (type_flags & GLSL_TextureSampler2D) {
-        return "0";
-    }
-    if (type_flags & GLSL_TextureSampler3D) {
-        return "0";
-    } 
-    if (type_flags & GLSL_TextureSamplerCube) {
-        return "0";
-    }
-    if (type_flags & GLSL_Float) {
-        return "1.0f";
-    }
-    if (type_flags & GLSL_UInt) {
-        return "1";
+        write_default_mat_val(writer, GetVecLenChar(type_flags));
+    } else if (type_flags & (GLSL_TextureSampler2D | GLSL_TextureSampler3D | GLSL_TextureSamplerCube)) {
+        writer << '0';
+    } else if (type_flags & GLSL_Float) {
+        writer << "1.0f";
+    } else if (type_flags & (GLSL_UInt | GLSL_Int)) {
+        writer << '1';
+    } else if (type_flags & GLSL_Bool) {
+        writer << "true";
+    } else if (type_flags & GLSL_Double) {
+        writer << "1.0";
     }
-    if (type_flags & GLSL_Int) {
-        return "1";
-    }
-    if (type_flags & GLSL_Bool) {
-        return "True";
-    }
-    if (type_flags & GLSL_Double) {
-        return "1.0";
-    }
-    return "";
 }
 
-std::string SS_Parser::ConvertOutputToColorStr(std::string pin_name, GLSL_TYPE type) {
+std::string SS_Parser::GLSLTypeToDefaultValue(GLSL_TYPE type) {
+    SS_Code_Writer& writer = GetScratchWriter();
+    WriteDefaultValue(writer, type);
+    return writer.View().str();
+}
+
+void SS_Parser::WriteOutputAsColor(SS_Code_Writer& writer, SS_String_View pin_name, GLSL_TYPE type) {
     if (GLSL_Float & type.type_flags) {
         if (type.type_flags & GLSL_Scalar)
-            return "vec4(" + pin_name + ", "  + pin_name + ", "  + pin_name + ", 1)";
-        if (type.type_flags & GLSL_Vec2)
-            return "vec4(" + pin_name + ".x, "  + pin_name + ".y, 0, 1)";
-        if (type.type_flags & GLSL_Vec3)
-            return "vec4(" + pin_name + ".x, "  + pin_name + ".y, "  + pin_name + ".z, 1)";
-        if (type.type_flags & GLSL_Vec4)
-            return "vec4(" + pin_name + ".xyz, 1)";
+            writer << "vec4(" << pin_name << ", " << pin_name << ", " << pin_name << ", 1)";
+        else if (type.type_flags & GLSL_Vec2)
+            writer << "vec4(" << pin_name << ".x, " << pin_name << ".y, 0, 1)";
+        else if (type.type_flags & GLSL_Vec3)
+            writer << "vec4(" << pin_name << ".x, " << pin_name << ".y, " << pin_name << ".z, 1)";
+        else if (type.type_flags & GLSL_Vec4)
+            writer << "vec4(" << pin_name << ".xyz, 1)";
+        else
+            writer << "vec4(1, 1, 1, 1)";
     } else if (GLSL_Bool & type.type_flags) {
         if (type.type_flags & GLSL_Scalar)
-            return pin_name + "? vec4(1,1,1,1) : vec4(0,0,0,1)";
-        if (type.type_flags & GLSL_Vec2)
-            return "mix(vec4(0,0,0,1), vec4(1,1,1,1),  bvec4(" + pin_name + ", true, true))";
-        if (type.type_flags & GLSL_Vec3)
-            return "mix(vec4(0,0,0,1), vec4(1,1,1,1),  bvec4(" + pin_name + ", true))";
-        if (type.type_flags & GLSL_Vec4)
-            return "mix(vec4(0,0,0,1), vec4(1,1,1,1), " + pin_name + ")";
+            writer << pin_name << "? vec4(1,1,1,1) : vec4(0,0,0,1)";
+        else if (type.type_flags & GLSL_Vec2)
+            writer << "mix(vec4(0,0,0,1), vec4(1,1,1,1),  bvec4(" << pin_name << ", true, true))";
+        else if (type.type_flags & GLSL_Vec3)
+            writer << "mix(vec4(0,0,0,1), vec4(1,1,1,1),  bvec4(" << pin_name << ", true))";
+        else if (type.type_flags & GLSL_Vec4)
+            writer << "mix(vec4(0,0,0,1), vec4(1,1,1,1), " << pin_name << ")";
+        else
+            writer << "vec4(1, 1, 1, 1)";
     } else if (GLSL_Double & type.type_flags) {
         if (type.type_flags & GLSL_Scalar)
-            return "vec4(float(" + pin_name + "), float("  + pin_name + "), float("  + pin_name + "), 1)";
-        if (type.type_flags & GLSL_Vec2)
-            return "vec4(float(" + pin_name + ".x), float("  + pin_name + ".y), 0, 1)";
-        if (type.type_flags & GLSL_Vec3)
-            return "vec4(float(" + pin_name + ".x), float("  + pin_name + ".y), float("  + pin_name + ".z), 1)";
-        if (type.type_flags & GLSL_Vec4)
-            return "vec4(float(" + pin_name + ".x), float(" + pin_name + ".y), float(" +  pin_name + ".z), " + "1)";
+            writer << "vec4(float(" << pin_name << "), float(" << pin_name << "), float(" << pin_name << "), 1)";
+        else if (type.type_flags & GLSL_Vec2)
+            writer << "vec4(float(" << pin_name << ".x), float(" << pin_name << ".y), 0, 1)";
+        else if (type.type_flags & GLSL_Vec3)
+            writer << "vec4(float(" << pin_name << ".x), float(" << pin_name << ".y), float(" << pin_name << ".z), 1)";
+        else if (type.type_flags & GLSL_Vec4)
+            writer << "vec4(float(" << pin_name << ".x), float(" << pin_name << ".y), float(" << pin_name << ".z), 1)";
+        else
+            writer << "vec4(1, 1, 1, 1)";
+    } else {
+        writer << "vec4(1, 1, 1, 1)";
     }
-    return "vec4(1, 1, 1, 1)";
+}
+
+std::string SS_Parser::ConvertOutputToColorStr(std::string pin_name, GLSL_TYPE type) {
+    SS_Code_Writer& writer = GetScratchWriter();
+    WriteOutputAsColor(writer, pin_name, type);
+    return writer.View().str();
 }
 
 std::string SS_Parser::StringToLower(const std::string &str) {
@@ -1,86 +1,81 @@
 #include "ss_pins.hpp"
 #include "ss_parser.hpp"
 #include "ss_graph.hpp"
+#include "ss_canvas_renderer.hpp"
 #include <algorithm>
-#include <queue>
+#include <stack>
+#include <unordered_set>
 
 
 ImVec2 Base_Pin::GetSize(float circle_off, float border) const {
-    ImVec2 text_size = ImGui::CalcTextSize(_name.c_str());
-    float circle_rad = text_size.y / 2;
-    return text_size + ImVec2(circle_rad + circle_off + border * 2, border * 2);
+    float circle_rad = textSize.y / 2;
+    return ImVec2(textSize.x + circle_rad + circle_off + border * 2, textSize.y + border * 2);
 }
 
 ImVec2 Base_InputPin::GetPinPos(float circle_off, float border, float* rad) {
     assert(rad);
     ImVec2 pos = owner->GetDrawPos() - ImVec2(owner->GetDrawRectSize().x * .5f, owner->GetDrawRectSize().y * .5f);
     ImVec2 bound_pos = owner->GetDrawInputPinRelativePos(index);
-    *rad = ImGui::CalcTextSize(_name.c_str()).y;
+    *rad = textSize.y;
     return pos + bound_pos + ImVec2(*rad + border, *rad + border);
 }
 
-void Base_InputPin::Draw(ImDrawList* d, ImVec2 pos, float circle_off, float border) {
-    ImVec2 text_size = ImGui::CalcTextSize(_name.c_str());
+void Base_InputPin::Draw(ImDrawList* d, SS_Canvas_Renderer& shapes, ImVec2 pos, float circle_off, float border,
+                         float zoom) {
     ImU32 color = SS_Parser::GLSLTypeToColor(type);
 
-    float circle_rad = text_size.y / 2;
+    float circle_rad = textSize.y / 2;
 
-    d->AddCircleFilled(pos + ImVec2(border + circle_rad, border + circle_rad), circle_rad, color);
-    d->AddText(pos + ImVec2(border + 2*circle_rad + circle_off, border), 0xffffffff, _name.c_str());
+    shapes.AddCircle(pos + ImVec2((border + circle_rad) * zoom, (border + circle_rad) * zoom), circle_rad * zoom, color);
+    d->AddText(ImGui::GetFont(), ImGui::GetFontSize() * zoom,
+               pos + ImVec2((border + 2*circle_rad + circle_off) * zoom, border * zoom), 0xffffffff,
+               _name.c_str(), _name.c_str() + _name.size());
 }
 
 void Base_InputPin::DisconnectAllFrom(bool reprop) {
-    if (input) {
-        auto* in_pin = this;
-        auto* out_pin = input;
-        in_pin->input = nullptr;
-        auto& outvec = out_pin->output;
-        out_pin->output.erase(std::find(outvec.begin(), outvec.end(), in_pin));
-
-        if (reprop) {
-            // INPUT PIN PROPOGATION
-            if (in_pin->type.type_flags & GLSL_GenType) {
-                unsigned int new_in_type = in_pin->owner->GetMostRestrictiveGentypeInSubgraph(in_pin);
-                in_pin->owner->PropagateGentypeInSubgraph(in_pin, new_in_type);
-            }
-            // OUTPUT PIN PROPOGATION
-            if (out_pin->type.type_flags & GLSL_GenType) {
-                unsigned int new_out_type = out_pin->owner->GetMostRestrictiveGentypeInSubgraph(out_pin);
-                out_pin->owner->PropagateGentypeInSubgraph(out_pin, new_out_type);
-            }
-        }
-        in_pin->owner->PropagateBuildDirty();
-    }
+    if (input)
+        PinOps::DisconnectPins(this, input, reprop);
 }
 
 ImVec2 Base_OutputPin::GetPinPos(float circle_off, float border, float* rad) {
     assert(rad);
     ImVec2 pos = owner->GetDrawPos() - ImVec2(owner->GetDrawRectSize().x * .5f, owner->GetDrawRectSize().y * .5f);
     ImVec2 bound_pos = owner->GetDrawOutputPinRelativePos(index);
-    ImVec2 text_size = ImGui::CalcTextSize(_name.c_str());
-    float off_x = text_size.x;
-    *rad = text_size.y;
+    float off_x = textSize.x;
+    *rad = textSize.y;
     return pos + bound_pos + ImVec2(*rad + border + circle_off + off_x, *rad + border);
 }
 
+bool Base_OutputPin::HasConnections() {
+    return owner->GetEdgeTable() and owner->GetEdgeTable()->HasOutEdges(*this);
+}
+
 void Base_OutputPin::DisconnectAllFrom(bool reprop) {
-    std::vector<Base_InputPin*> output_COPY(output);
-    for (Base_InputPin* i_pin : output_COPY)
+    SS_Edge_Table* edges = owner->GetEdgeTable();
+    if (not edges) return;
+    // Collected first, disconnecting changes the table
+    std::vector<Base_InputPin*> connected;
+    edges->ForEachOutEdge(owner->GetID(), [&](uint32_t e) {
+        if (edges->GetSourcePin(e) == index) connected.push_back(&edges->GetInputPin(e));
+    });
+    for (Base_InputPin* i_pin : connected)
         PinOps::DisconnectPins(i_pin, this, true);
 }
 
-void Base_OutputPin::Draw(ImDrawList* d, ImVec2 pos, float circle_off, float border) {
-    ImVec2 text_size = ImGui::CalcTextSize(_name.c_str());
+void Base_OutputPin::Draw(ImDrawList* d, SS_Canvas_Renderer& shapes, ImVec2 pos, float circle_off, float border,
+                          float zoom) {
     ImU32 color = SS_Parser::GLSLTypeToColor(type);
 
-    float circle_rad = text_size.y / 2;
+    float circle_rad = textSize.y / 2;
 
-    d->AddText(pos + ImVec2(border, border), 0xffffffff, _name.c_str());
-    d->AddCircleFilled(pos + ImVec2(text_size.x + border + circle_off + circle_rad, border + circle_rad), circle_rad, color);
+    d->AddText(ImGui::GetFont(), ImGui::GetFontSize() * zoom, pos + ImVec2(border * zoom, border * zoom), 0xffffffff,
+               _name.c_str(), _name.c_str() + _name.size());
+    shapes.AddCircle(pos + ImVec2((textSize.x + border + circle_off + circle_rad) * zoom, (border + circle_rad) * zoom),
+                     circle_rad * zoom, color);
 }
 
-std::string Base_OutputPin::get_pin_output_name() {
-    return owner->RequestOutput(index);
+SS_String_View Base_OutputPin::get_pin_output_name() const {
+    return owner->GetCachedOutput(index);
 }
 
 
@@ -88,22 +83,60 @@ std::string Base_OutputPin::get_pin_output_name() {
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  *************************************************************************************************************/
 
-// returns TRUE if DAG violation
-bool PinOps::CheckForDAGViolation(Base_InputPin* in_pin, Base_OutputPin* out_pin) {
-    std::queue<Base_GraphNode*> n_queue;
-    Base_GraphNode* n;
-    n_queue.push(in_pin->owner);
-    while (!n_queue.empty()) {
-        n = n_queue.front();
-        n_queue.pop();
-        if (n == out_pin->owner) return true;
-        for (int p = 0; p < n->GetOutputPinCount(); ++p)
-            for (auto & o : n->GetOutputPin(p).output)
-                n_queue.push(o->owner);
+/**
+ * Nodes reachable from start through output connections, limited to those ordered at or before upper_index.
+ * Any node ordered after upper_index can't lead back to a node at or before it, so the search stays within
+ * the region between the two ends of a new connection.
+ * @return True if target was reached
+ */
+static bool CollectForwardRegion(Base_GraphNode* start, int upper_index, const Base_GraphNode* target,
+                                 std::vector<Base_GraphNode*>& region) {
+    std::unordered_set<Base_GraphNode*> visited{start};
+    std::stack<Base_GraphNode*> n_stack;
+    n_stack.push(start);
+    while (!n_stack.empty()) {
+        Base_GraphNode* n = n_stack.top();
+        n_stack.pop();
+        if (n == target) return true;
+        region.push_back(n);
+        SS_Edge_Table* edges = n->GetEdgeTable();
+        if (not edges) continue;
+        edges->ForEachOutEdge(n->GetID(), [&](uint32_t e) {
+            Base_GraphNode* o = edges->GetInputPin(e).owner;
+            if (o->GetTopologicalIndex() > upper_index or not visited.insert(o).second) return;
+            n_stack.push(o);
+        });
     }
     return false;
 }
 
+// Nodes reaching start through input connections, limited to those ordered after lower_index
+static void CollectBackwardRegion(Base_GraphNode* start, int lower_index, std::vector<Base_GraphNode*>& region) {
+    std::unordered_set<Base_GraphNode*> visited{start};
+    std::stack<Base_GraphNode*> n_stack;
+    n_stack.push(start);
+    while (!n_stack.empty()) {
+        Base_GraphNode* n = n_stack.top();
+        n_stack.pop();
+        region.push_back(n);
+        for (int p = 0; p < n->GetInputPinCount(); ++p) {
+            Base_OutputPin* i = n->GetInputPin(p).input;
+            if (not i or i->owner->GetTopologicalIndex() <= lower_index or not visited.insert(i->owner).second) continue;
+            n_stack.push(i->owner);
+        }
+    }
+}
+
+// returns TRUE if DAG violation
+bool PinOps::CheckForDAGViolation(Base_InputPin* in_pin, Base_OutputPin* out_pin) {
+    Base_GraphNode* from = out_pin->owner;
+    Base_GraphNode* to = in_pin->owner;
+    // Already in order, nothing downstream of to can come before from
+    if (from->GetTopologicalIndex() < to->GetTopologicalIndex()) return false;
+    std::vector<Base_GraphNode*> region;
+    return from == to or CollectForwardRegion(to, from->GetTopologicalIndex(), from, region);
+}
+
 // 0 for input change needed, 1 for no change needed, 2 for output changed needed
 // -1 for failed
 bool PinOps::ArePinsConnectable(Base_InputPin* in_pin, Base_OutputPin* out_pin) {
@@ -113,19 +146,47 @@ bool PinOps::ArePinsConnectable(Base_InputPin* in_pin, Base_OutputPin* out_pin)
     return in_accepeted && out_accepeted && dag_maintained;
 }
 
+// Pearce-Kelly reordering: the nodes leading to from move ahead of the nodes following to, reusing their indices
+static void ReorderForConnection(Base_GraphNode* from, Base_GraphNode* to) {
+    int lower_index = to->GetTopologicalIndex();
+    int upper_index = from->GetTopologicalIndex();
+    if (upper_index < lower_index) return;
+
+    std::vector<Base_GraphNode*> forward, backward;
+    CollectForwardRegion(to, upper_index, from, forward);
+    CollectBackwardRegion(from, lower_index, backward);
+    auto byIndex = [](const Base_GraphNode* a, const Base_GraphNode* b) {
+        return a->GetTopologicalIndex() < b->GetTopologicalIndex();
+    };
+    std::sort(forward.begin(), forward.end(), byIndex);
+    std::sort(backward.begin(), backward.end(), byIndex);
+
+    std::vector<int> indices;
+    indices.reserve(forward.size() + backward.size());
+    for (const std::vector<Base_GraphNode*>* region : { &backward, &forward }) {
+        for (Base_GraphNode* n : *region)
+            indices.push_back(n->GetTopologicalIndex());
+    }
+    std::sort(indices.begin(), indices.end());
+    size_t next = 0;
+    for (const std::vector<Base_GraphNode*>* region : { &backward, &forward }) {
+        for (Base_GraphNode* n : *region)
+            n->SetTopologicalIndex(indices[next++]);
+    }
+}
+
 bool PinOps::ConnectPins(Base_InputPin* in_pin, Base_OutputPin* out_pin) {
+    assert(in_pin->owner->GetEdgeTable() and in_pin->owner->GetEdgeTable() == out_pin->owner->GetEdgeTable());
     if (!ArePinsConnectable(in_pin, out_pin)) return false;
 
     if (in_pin->input)
         DisconnectPins(in_pin, in_pin->input, true);
 
-    GLSL_TYPE intersect_type = in_pin->type.IntersectCopy(out_pin->type);
-    in_pin->owner->PropagateGentypeInSubgraph(in_pin, intersect_type.type_flags & GLSL_LenMask);
-    out_pin->owner->PropagateGentypeInSubgraph(out_pin, intersect_type.type_flags & GLSL_LenMask);
+    JoinGentypes(in_pin, out_pin);
     in_pin->owner->PropagateBuildDirty();
 
-    in_pin->input = out_pin;
-    out_pin->output.push_back(in_pin);
+    ReorderForConnection(out_pin->owner, in_pin->owner);
+    in_pin->owner->GetEdgeTable()->Link(*out_pin, *in_pin);
     in_pin->owner->InformOfConnect(in_pin, out_pin);
     out_pin->owner->InformOfConnect(in_pin, out_pin);
 
@@ -133,23 +194,25 @@ bool PinOps::ConnectPins(Base_InputPin* in_pin, Base_OutputPin* out_pin) {
 }
 
 
+void PinOps::JoinGentypes(Base_InputPin* in_pin, Base_OutputPin* out_pin) {
+    bool in_generic = in_pin->type.type_flags & GLSL_GenType;
+    bool out_generic = out_pin->type.type_flags & GLSL_GenType;
+    if (in_generic and out_generic)
+        Base_GraphNode::UniteGentypes(in_pin->owner, out_pin->owner);
+    else if (in_generic)
+        in_pin->owner->RestrictGentype(out_pin->type.type_flags & GLSL_LenMask);
+    else if (out_generic)
+        out_pin->owner->RestrictGentype(in_pin->type.type_flags & GLSL_LenMask);
+}
+
 bool PinOps::DisconnectPins(Base_InputPin* in_pin, Base_OutputPin* out_pin, bool reprop) {
-    in_pin->input = nullptr;
-    auto ptr = std::find(out_pin->output.begin(), out_pin->output.end(), in_pin);
-    out_pin->output.erase(ptr);
-
-    if (reprop) {
-        // INPUT PIN PROPOGATION
-        if (in_pin->type.type_flags & GLSL_GenType) {
-            unsigned int new_in_type = in_pin->owner->GetMostRestrictiveGentypeInSubgraph(in_pin);
-            in_pin->owner->PropagateGentypeInSubgraph(in_pin, new_in_type);
-        }
-        // OUTPUT PIN PROPOGATION
-        if (out_pin->type.type_flags & GLSL_GenType) {
-            unsigned int new_out_type = out_pin->owner->GetMostRestrictiveGentypeInSubgraph(out_pin);
-            out_pin->owner->PropagateGentypeInSubgraph(out_pin, new_out_type);
-        }
-    }
+    in_pin->owner->GetEdgeTable()->Unlink(*in_pin);
+
+    // The class of connected generic pins covers both ends, so one rebuild handles either of them
+    if (in_pin->type.type_flags & GLSL_GenType)
+        in_pin->owner->SplitGentype(reprop);
+    else if (out_pin->type.type_flags & GLSL_GenType)
+        out_pin->owner->SplitGentype(reprop);
     in_pin->owner->PropagateBuildDirty();
     return true;
 }
@@ -5,10 +5,13 @@
 #include <string>
 #include <vector>
 #include "ss_node_types.hpp"
+#include "ss_code_writer.hpp"
+#include "ss_name.hpp"
 #include "imgui/imgui.h"
 
 // WARNING: coupling to GraphNode
 class Base_GraphNode;
+class SS_Canvas_Renderer;
 
 // BASE CLASS FOR NODE PINS
 struct Base_Pin {
@@ -16,10 +19,16 @@ struct Base_Pin {
     int index;
     GLSL_TYPE type;
     bool bInput;
-    std::string _name;
+    SS_Name _name;
+    // Extent of the name, and where the pin sits relative to the owner's upper left.
+        // Set with the owner's layout by Base_GraphNode::SetBounds
+    ImVec2 textSize;
+    ImVec2 relPos;
 
     ImVec2 GetSize(float circle_off, float border) const;
-    virtual void Draw(ImDrawList* drawList, ImVec2 pos, float circle_off, float border) {};
+    // Draw at the screen position of the pin's upper left, scaled by the zoom, the circle with the canvas renderer
+    virtual void Draw(ImDrawList* drawList, SS_Canvas_Renderer& shapes, ImVec2 pos, float circle_off, float border,
+                      float zoom) {};
     virtual ImVec2 GetPinPos(float circle_off, float border, float* radius) { return {0, 0}; };
 
     virtual bool HasConnections() { return false; }
@@ -32,34 +41,41 @@ struct Base_OutputPin;
 
 // INPUT PIN CLASS
 struct Base_InputPin : Base_Pin {
+    // The connected source, written only by SS_Edge_Table::Link and Unlink
     Base_OutputPin* input = nullptr;
-    void Draw(ImDrawList* drawList, ImVec2 pos, float circle_off, float border) override;
+    void Draw(ImDrawList* drawList, SS_Canvas_Renderer& shapes, ImVec2 pos, float circle_off, float border,
+              float zoom) override;
     ImVec2 GetPinPos(float circle_off, float border, float* radius) override;
     bool HasConnections() override { return input; }
     void DisconnectAllFrom(bool reprop) override;
 };
 
-// OUTPUT PIN CLASS
+// OUTPUT PIN CLASS, its connections are in the graph's SS_Edge_Table
 struct Base_OutputPin : Base_Pin {
-    std::vector<Base_InputPin*> output;
-    std::string get_pin_output_name();
-    void Draw(ImDrawList* drawList, ImVec2 pos, float circle_off, float border) override;
+    SS_String_View get_pin_output_name() const;
+    void Draw(ImDrawList* drawList, SS_Canvas_Renderer& shapes, ImVec2 pos, float circle_off, float border,
+              float zoom) override;
     ImVec2 GetPinPos(float circle_off, float border, float* radius) override;
-    bool HasConnections() override { return not output.empty(); }
+    bool HasConnections() override;
     void DisconnectAllFrom(bool reprop) override;
 };
 
 
 namespace PinOps {
     /**
-     * Tracks through previously constructed graph to determine if adding an edge from in_pin to out_pin will result in
-     * a cycle.
+     * Determine if adding an edge from out_pin to in_pin will result in a cycle.
+     * Only searches the nodes between the two in the topological order, and nothing when they are already in order.
      * WARNING: This explicitly assumes m_nodes are Base_GraphNode.
-     * @return True iff adding the edge would NOT result a cycle (i.e. it would maintain DAG).
+     * @return True iff adding the edge would result a cycle (i.e. it would NOT maintain DAG).
      */
     bool CheckForDAGViolation(Base_InputPin *in_pin, Base_OutputPin *out_pin);
     bool ArePinsConnectable(Base_InputPin* in_pin, Base_OutputPin* out_pin);
+    // Connect the pins and restore the topological order of the nodes, see Base_GraphNode::GetTopologicalIndex.
+        // Both nodes must be in a graph, the connection is added to its edge table
     bool ConnectPins(Base_InputPin* in_pin, Base_OutputPin* out_pin);
+    // Give the pins' generic types a common length, for pins just linked
+    void JoinGentypes(Base_InputPin* in_pin, Base_OutputPin* out_pin);
+    // Without reprop, generic pins keep the lengths they had while connected
     bool DisconnectPins(Base_InputPin* in_pin, Base_OutputPin* out_pin, bool reprop);
 }
 
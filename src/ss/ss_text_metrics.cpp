@@ -0,0 +1,25 @@
+#include "ss_text_metrics.hpp"
+#include <vector>
+
+namespace {
+    // By name ID, negative until measured
+    std::vector<ImVec2> s_sizes;
+    const ImFont* s_font = nullptr;
+    float s_fontSize = 0;
+}
+
+ImVec2 SS_Text_Metrics::GetTextSize(SS_Name text) {
+    const ImFont* font = ImGui::GetFont();
+    float font_size = ImGui::GetFontSize();
+    if (font != s_font or font_size != s_fontSize) {
+        s_sizes.clear();
+        s_font = font;
+        s_fontSize = font_size;
+    }
+    if (text.GetID() >= s_sizes.size())
+        s_sizes.resize(SS_Name::GetCount(), ImVec2(-1, -1));
+    ImVec2& size = s_sizes[text.GetID()];
+    if (size.x < 0)
+        size = ImGui::CalcTextSize(text.c_str(), text.c_str() + text.size());
+    return size;
+}
@@ -0,0 +1,16 @@
+#ifndef SS_TEXT_METRICS
+#define SS_TEXT_METRICS
+
+#include "imgui/imgui.h"
+#include "ss_name.hpp"
+
+/**
+ * Extents of node and pin names in the current ImGui font, measured once per name.
+ * Measurements are kept by name ID and all dropped when the font or its size changes.
+ */
+namespace SS_Text_Metrics {
+    // Same as ImGui::CalcTextSize of the name, for the current font and font size
+    ImVec2 GetTextSize(SS_Name text);
+}
+
+#endif
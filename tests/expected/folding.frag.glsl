@@ -0,0 +1,29 @@
+#version 400
+    uniform mat4 u_model_mat;
+    uniform mat4 u_mvp;
+    uniform vec3 u_base_color;
+    uniform float u_time;
+    uniform vec3 u_objectPos;
+    
+    in vec3 f_color;
+    in vec2 f_texcoord;
+    
+    in vec3 f_WorldPos;
+    in vec3 f_ViewPos;
+    in vec3 f_LocalPos;
+    in vec3 f_WorldNormal;
+    in vec3 f_LocalNormal;
+    in vec3 f_ViewNormal;
+uniform  vec3 P_tint;
+
+void main() {
+// UNLIT
+	  // Node Vec3, id=3
+	  // Node sin, id=4
+	  // Node add_(+), id=5
+	  // Node P_tint, id=8
+	 vec3 INTERNAL_VAR_6_0 = ( vec3(0.19983342, 0.66052806, -4e-07)+ P_tint);  // Node add_(+), id=6
+	  // Node TERMINAL VERTEX         , id=2
+	gl_FragColor = vec4(INTERNAL_VAR_6_0, 1);
+}
+
@@ -0,0 +1,40 @@
+#version 400
+    uniform mat4 u_model_mat;
+    uniform mat4 u_mvp;
+    uniform vec3 u_base_color;
+    uniform float u_time;
+    uniform vec3 u_objectPos;
+    
+    layout(location = 0) in vec3 in_vertex;
+    layout(location = 1) in vec3 in_color;
+    layout(location = 2) in vec2 in_texcoord;
+    layout(location = 3) in vec3 in_normal;
+    
+    out vec3 f_color;
+    out vec2 f_texcoord;
+    
+    out vec3 f_WorldPos;
+    out vec3 f_ViewPos;
+    out vec3 f_LocalPos;
+    out vec3 f_WorldNormal;
+    out vec3 f_LocalNormal;
+    out vec3 f_ViewNormal;
+uniform  vec3 P_tint;
+
+void main() {
+
+        f_color = in_color;
+        f_texcoord = in_texcoord;
+    
+        f_LocalPos = in_vertex;
+        f_LocalNormal = in_normal;
+        f_WorldNormal = (vec4(in_vertex, 1.0) * u_model_mat).xyz;
+        f_WorldPos = (vec4(in_vertex, 1.0) * u_model_mat).xyz;
+        f_ViewNormal = (vec4(in_vertex, 1.0) * u_mvp).xyz;
+        f_ViewPos = (vec4(in_vertex, 1.0) * u_mvp).xyz;
+    
+        gl_Position = (vec4(in_vertex, 1.0) * u_mvp);
+	  // Node TERMINAL VERTEX         , id=1
+
+}
+
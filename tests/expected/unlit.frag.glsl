@@ -0,0 +1,30 @@
+#version 400
+    uniform mat4 u_model_mat;
+    uniform mat4 u_mvp;
+    uniform vec3 u_base_color;
+    uniform float u_time;
+    uniform vec3 u_objectPos;
+    
+    in vec3 f_color;
+    in vec2 f_texcoord;
+    
+    in vec3 f_WorldPos;
+    in vec3 f_ViewPos;
+    in vec3 f_LocalPos;
+    in vec3 f_WorldNormal;
+    in vec3 f_LocalNormal;
+    in vec3 f_ViewNormal;
+uniform  vec3 P_tint;
+
+void main() {
+// UNLIT
+	  // Node Vec3, id=3
+	  // Node WORLD NORMAL, id=7
+	 vec3 INTERNAL_VAR_4_0 = sin( f_WorldNormal);  // Node sin, id=4
+	 vec3 INTERNAL_VAR_5_0 = ( INTERNAL_VAR_4_0+ vec3(0.1, 0.333333, -2e-07));  // Node add_(+), id=5
+	  // Node P_tint, id=8
+	 vec3 INTERNAL_VAR_6_0 = ( INTERNAL_VAR_5_0+ P_tint);  // Node add_(+), id=6
+	  // Node TERMINAL VERTEX         , id=2
+	gl_FragColor = vec4(INTERNAL_VAR_6_0, 1);
+}
+
@@ -0,0 +1,21 @@
+# Shaders generated from a graph by the headless CLI, compared with the expected ones.
+# After an intended change to code generation, regenerate the expected shaders with
+#   shader_sculptor_cli --out tests/expected tests/graphs/<graph>.ssg
+# Usage: cmake -DCLI=<shader_sculptor_cli> -DGRAPH=<graph> -DEXPECTED=<expected dir> -DWORK=<scratch dir> -P graph_glsl.cmake
+
+get_filename_component(STEM "${GRAPH}" NAME_WE)
+file(REMOVE_RECURSE "${WORK}")
+file(MAKE_DIRECTORY "${WORK}")
+
+execute_process(COMMAND "${CLI}" --out "${WORK}" "${GRAPH}" RESULT_VARIABLE result OUTPUT_QUIET)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "shader_sculptor_cli failed on ${GRAPH}: ${result}")
+endif ()
+
+foreach (stage vert frag)
+    execute_process(COMMAND "${CMAKE_COMMAND}" -E compare_files
+            "${EXPECTED}/${STEM}.${stage}.glsl" "${WORK}/${STEM}.${stage}.glsl" RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "${WORK}/${STEM}.${stage}.glsl differs from ${EXPECTED}/${STEM}.${stage}.glsl")
+    endif ()
+endforeach ()
@@ -0,0 +1,32 @@
+# Round-trip of a text graph through the binary format, with the headless CLI.
+# The text graph is saved as .ssgb, which is loaded and saved again: both binaries must be identical, and the shaders
+# generated from the binary must match those generated from the text.
+# Usage: cmake -DCLI=<shader_sculptor_cli> -DGRAPH=<graph.ssg> -DWORK=<scratch dir> -P graph_round_trip.cmake
+
+get_filename_component(STEM "${GRAPH}" NAME_WE)
+file(REMOVE_RECURSE "${WORK}")
+file(MAKE_DIRECTORY "${WORK}/text" "${WORK}/binary" "${WORK}/resaved")
+
+function(run_cli)
+    execute_process(COMMAND "${CLI}" ${ARGN} RESULT_VARIABLE result OUTPUT_QUIET)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "shader_sculptor_cli ${ARGN} failed: ${result}")
+    endif ()
+endfunction()
+
+function(expect_same_file expected actual)
+    execute_process(COMMAND "${CMAKE_COMMAND}" -E compare_files "${expected}" "${actual}" RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "${actual} differs from ${expected}")
+    endif ()
+endfunction()
+
+run_cli(--out "${WORK}/text" --save "${WORK}/${STEM}.ssgb" "${GRAPH}")
+run_cli(--out "${WORK}/binary" --save "${WORK}/resaved/${STEM}.ssgb" "${WORK}/${STEM}.ssgb")
+run_cli(--out "${WORK}/resaved" "${WORK}/resaved/${STEM}.ssgb")
+
+expect_same_file("${WORK}/${STEM}.ssgb" "${WORK}/resaved/${STEM}.ssgb")
+foreach (stage vert frag)
+    expect_same_file("${WORK}/text/${STEM}.${stage}.glsl" "${WORK}/binary/${STEM}.${stage}.glsl")
+    expect_same_file("${WORK}/text/${STEM}.${stage}.glsl" "${WORK}/resaved/${STEM}.${stage}.glsl")
+endforeach ()